@@ -24,6 +24,7 @@
 #include "directory_entry.hh"
 #include "file_header.hh"
 #include "lib/utility.hh"
+#include "threads/rw_lock.hh"
 #include "threads/system.hh"
 
 #include <stdio.h>
@@ -62,10 +63,10 @@ Directory::~Directory()
 ///
 /// * `file` is file containing the directory contents.
 void
-Directory::FetchFrom(OpenFile *file)
+Directory::FetchFrom(OpenFile *file, bool shared)
 {
     ASSERT(file != nullptr);
-    TakeLock();
+    TakeLock(shared);
     file->ReadAt((char *) &raw.tableSize, sizeof(unsigned), 0);
     
     /// Maybe the raw.table is smaller than the disk version, we resize it.
@@ -122,7 +123,7 @@ Directory::FindIndex(const char *name, bool directory)
 {
     ASSERT(name != nullptr);
     ASSERT(strlen(name) != 0);
-    TakeLock();
+    TakeLock(true);
     for (unsigned i = 0; i < raw.tableSize; i++) {
         if(raw.table[i].inUse){
             DEBUG('v', "aca hay %s con sector %d, iteracion %d. \n", raw.table[i].name, raw.table[i].sector, i);
@@ -173,22 +174,29 @@ Directory::Find(const char *name, bool directory) // hola/pepe/hola.txt --> hola
             return -1;
         }
         int sect = raw.table[i].sector;
-        Lock *l = fileSystem->GetLock(sect);
-        if(!l->IsHeldByCurrentThread())
-            l->Acquire(); 
-        FileHeader *hdr;
-        if(openFileList->HasKey(sect)) {
-            hdr = openFileList->GetByKey(sect);
-        } else {
-            hdr = new FileHeader;
-            hdr->FetchFrom(sect);
-            openFileList->AppendKey(hdr, sect);
+        RWLock *l = fileSystem->GetLock(sect);
+        bool held = l->IsHeldByCurrentThread() || l->IsReadByCurrentThread();
+        // Looking up the header and reading the subdirectory only need the
+        // lock of its sector shared.
+        if(!held)
+            l->AcquireRead();
+        FileHeader *hdr = openFileList->Get(sect);
+        if(hdr == nullptr) {
+            // Other threads reading the directory may fetch the header too;
+            // only the first one to add it keeps it.
+            FileHeader *fetched = new FileHeader;
+            fetched->FetchFrom(sect);
+            hdr = openFileList->GetOrAdd(sect, fetched);
+            if(hdr != fetched)
+                delete fetched;
         }
-        OpenFile *dir = new OpenFile(sect, hdr);
-        Directory *d = new Directory(1);
-        d->FetchFrom(dir);
-        if(l->IsHeldByCurrentThread())
-            l->Release(); 
+        if(!held)
+            l->ReleaseRead();
+        OpenFile *dir = new OpenFile(sect, hdr);  // Takes the lock itself.
+        Directory *d = new Directory(1, sect);
+        d->FetchFrom(dir, true);
+        if(!held)
+            d->ReleaseLock();
         char *rest = &(path[strlen(str)+1]);
         i = d->Find(rest,directory);
         delete d;
@@ -297,15 +305,23 @@ Directory::GetRaw() const
 }
 
 void 
-Directory::TakeLock(){
-    Lock *lock = fileSystem->GetLock(sector);
-    if(!lock->IsHeldByCurrentThread()) /// Prevent double acquire
-        lock->Acquire();
+Directory::TakeLock(bool shared){
+    RWLock *lock = fileSystem->GetLock(sector);
+    // A shared hold cannot be upgraded: writers would then run under it.
+    ASSERT(shared || !lock->IsReadByCurrentThread());
+    if(lock->IsHeldByCurrentThread() || lock->IsReadByCurrentThread())
+        return; /// Prevent double acquire
+    if(shared)
+        lock->AcquireRead();
+    else
+        lock->AcquireWrite();
 }
 
 void 
 Directory::ReleaseLock(){
-    Lock *lock = fileSystem->GetLock(sector);
+    RWLock *lock = fileSystem->GetLock(sector);
     if(lock->IsHeldByCurrentThread()) /// Prevent double release
-        lock->Release();
+        lock->ReleaseWrite();
+    else if(lock->IsReadByCurrentThread())
+        lock->ReleaseRead();
 }
\ No newline at end of file
@@ -41,8 +41,10 @@ public:
     /// De-allocate the directory.
     ~Directory();
 
-    /// Initialize directory contents from disk.
-    void FetchFrom(OpenFile *file);
+    /// Initialize directory contents from disk.  The directory stays
+    /// locked, for writing unless it is only going to be looked up
+    /// (`shared`).
+    void FetchFrom(OpenFile *file, bool shared = false);
 
     /// Write modifications to directory contents back to disk.
     void WriteBack(OpenFile *file);
@@ -72,8 +74,11 @@ public:
     /// Find the index into the directory table corresponding to `name`.
     int FindIndex(const char *name, bool directory = false);
 
-    void TakeLock();
+    /// Lock the directory, along with other readers if `shared`, unless
+    /// the current thread already holds it (in either mode).
+    void TakeLock(bool shared = false);
 
+    /// Unlock the directory, in whichever mode the current thread holds it.
     void ReleaseLock();
     
     unsigned sector;
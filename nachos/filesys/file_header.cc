@@ -24,6 +24,7 @@
 
 
 #include "file_header.hh"
+#include "threads/rw_lock.hh"
 #include "threads/system.hh"
 
 #include <ctype.h>
@@ -80,8 +81,11 @@ FileHeader::Allocate(Bitmap *freeMap, unsigned fileSize, unsigned maxDirectBlock
                                                                                    ///> headers.
     }
 
+    ///> Direct blocks, in a row if there is room for them, so that the
+    ///> file can be read without seeking back and forth.
+    int first = numDirectBlocks > 0 ? freeMap->FindContiguous(numDirectBlocks) : -1;
     for (unsigned i = 0; i < numDirectBlocks; i++) {
-        raw.dataSectors[i] = freeMap->Find(); ///> direct blocks.
+        raw.dataSectors[i] = first != -1 ? first + i : freeMap->Find();
     }
 
     ///> If it wasn't necessary a doubly-indirection pointer, return.
@@ -219,14 +223,14 @@ FileHeader::ByteToSector(unsigned offset)
         
         ///> Here, we extract the diferent sectors along the path of headers until get the
         ///> sector needed.
+        ///> The headers are only read, under the lock the caller (`ReadAt`
+        ///> or `WriteAt`) already holds, maybe shared.
         unsigned doublyHeaderSector = raw.dataSectors[NUM_DIRECT];
-        TakeLock();
         FileHeader *doublyHeader = new FileHeader;
         doublyHeader->FetchFrom(doublyHeaderSector);
         
         unsigned sectorOfHeaderNeeded = doublyHeader->GetRaw()->dataSectors[offsetInDoublyIndHeader];
         
-        doublyHeader->WriteBack(doublyHeaderSector);
         delete doublyHeader;
 
         FileHeader *headerNeeded = new FileHeader;
@@ -234,9 +238,7 @@ FileHeader::ByteToSector(unsigned offset)
         
         unsigned dataSector = headerNeeded->GetRaw()->dataSectors[offsetInHeaderNeeded];
         
-        headerNeeded->WriteBack(sectorOfHeaderNeeded);
         delete headerNeeded;
-        ReleaseLock();
         
         return dataSector;
     } else {
@@ -451,15 +453,23 @@ FileHeader::IncrementNumSectors() {
 }
 
 void
-FileHeader::TakeLock() {
-    Lock *lock = fileSystem->GetLock(hsector);
-    if(!lock->IsHeldByCurrentThread()) /// Prevent double release
-        lock->Acquire();
+FileHeader::TakeLock(bool shared) {
+    RWLock *lock = fileSystem->GetLock(hsector);
+    // A shared hold cannot be upgraded: writers would then run under it.
+    ASSERT(shared || !lock->IsReadByCurrentThread());
+    if(lock->IsHeldByCurrentThread() || lock->IsReadByCurrentThread())
+        return; /// Prevent double acquire
+    if(shared)
+        lock->AcquireRead();
+    else
+        lock->AcquireWrite();
 }
 
 void
 FileHeader::ReleaseLock() {
-    Lock *lock = fileSystem->GetLock(hsector);
+    RWLock *lock = fileSystem->GetLock(hsector);
     if(lock->IsHeldByCurrentThread()) /// Prevent double release
-        lock->Release();
+        lock->ReleaseWrite();
+    else if(lock->IsReadByCurrentThread())
+        lock->ReleaseRead();
 }
\ No newline at end of file
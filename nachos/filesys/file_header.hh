@@ -87,10 +87,11 @@ public:
     /// Add data sector to the last position at header 
     void AppendDataSector(unsigned sector);
     
-    /// Acquire lock
-    void TakeLock();
+    /// Acquire lock, along with other readers if `shared`, unless the
+    /// current thread already holds it (in either mode).
+    void TakeLock(bool shared = false);
 
-    /// Release lock 
+    /// Release lock, in whichever mode the current thread holds it.
     void ReleaseLock();
 
     bool removed;
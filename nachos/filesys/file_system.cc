@@ -46,12 +46,13 @@
 #include "directory.hh"
 #include "file_header.hh"
 #include "lib/bitmap.hh"
+#include "threads/rw_lock.hh"
 #include "threads/system.hh"
 #include "system.hh"
 #include <stdio.h>
 #include <string.h>
 
-extern Lock **locksSector;
+extern RWLock **locksSector;
 
 
 /// Initialize the file system.  If `format == true`, the disk has nothing on
@@ -200,20 +201,20 @@ FileSystem::Create(const char *name, unsigned initialSize, int dirsector)
     else{
         dir = new Directory(NUM_DIR_ENTRIES, dirsector);
         FileHeader *hdr = nullptr;
-        Lock *l = fileSystem->GetLock(dirsector);
-        if(!l->IsHeldByCurrentThread())
-            l->Acquire();
+        RWLock *l = fileSystem->GetLock(dirsector);
+        if(!l->IsHeldByCurrentThread() && !l->IsReadByCurrentThread())
+            l->AcquireWrite();
         if(openFileList->HasKey(dirsector)) {
-            hdr = openFileList->GetByKey(dirsector);
+            hdr = openFileList->Get(dirsector);
         } else {
             hdr = new FileHeader;
             hdr->FetchFrom(dirsector);
-            openFileList->AppendKey(hdr, dirsector);
+            openFileList->Add(dirsector, hdr);
         }
         d = new OpenFile(dirsector, hdr);
         dir->FetchFrom(d);
         if(l->IsHeldByCurrentThread())
-            l->Release();
+            l->ReleaseWrite();
     }
     
     bool success = true;
@@ -310,18 +311,18 @@ FileSystem::Open(const char *name)
     OpenFile  *openFile = nullptr;
 
     DEBUG('f', "Opening file %s by %s\n", name, currentThread->GetName());
-    dir->FetchFrom(directoryFile);
+    dir->FetchFrom(directoryFile, true);
     int sector = dir->Find(name);
     if (sector >= 0) {
         FileHeader *hdr = nullptr;
         ///> If the file was opened by other process, 
         ///> the file header is shared.
         #ifdef FILESYS
-        Lock *l = fileSystem->GetLock(sector);
-        if(!l->IsHeldByCurrentThread())
-            l->Acquire();
+        RWLock *l = fileSystem->GetLock(sector);
+        if(!l->IsHeldByCurrentThread() && !l->IsReadByCurrentThread())
+            l->AcquireWrite();
         if(openFileList->HasKey(sector)) {
-            hdr = openFileList->GetByKey(sector);
+            hdr = openFileList->Get(sector);
         } else {
             DEBUG('u',"no hay key para archivo %s con sector %d\n", name, sector);
             ///> If the file wasn´t opened, its file header
@@ -329,13 +330,13 @@ FileSystem::Open(const char *name)
             ///> by its sector number at the disk .
             hdr = new FileHeader;
             hdr->FetchFrom(sector);
-            openFileList->AppendKey(hdr, sector);
+            openFileList->Add(sector, hdr);
             ASSERT(openFileList->HasKey(sector));
         }
         #endif
         openFile = new OpenFile(sector, hdr);  // `name` was found in directory.
         if(l->IsHeldByCurrentThread())
-            l->Release();
+            l->ReleaseWrite();
     } else {
         DEBUG('f', "File %s not found\n", name);
     }
@@ -381,23 +382,23 @@ FileSystem::Remove(const char *name, FileHeader *hdr, int hsector)
                 delete dir;
                 return false;  // file not found
             }
-            Lock *l = GetLock(headersector);
-            if(!l->IsHeldByCurrentThread())
-                l->Acquire();
+            RWLock *l = GetLock(headersector);
+            if(!l->IsHeldByCurrentThread() && !l->IsReadByCurrentThread())
+                l->AcquireWrite();
             FileHeader *hdr1;
             if(openFileList->HasKey(headersector)) {
-                hdr1 = openFileList->GetByKey(headersector);
+                hdr1 = openFileList->Get(headersector);
             } else {
                 DEBUG('u',"no esta el sector %d para header de %s con path %s\n", headersector, name, path);
                 hdr1 = new FileHeader;
                 hdr1->FetchFrom(headersector);
-                openFileList->AppendKey(hdr1, headersector);
+                openFileList->Add(headersector, hdr1);
                 ASSERT(openFileList->HasKey(headersector));
             }
             d = new OpenFile(headersector, hdr1);
             dir->FetchFrom(d);
             if(l->IsHeldByCurrentThread())
-                l->Release();
+                l->ReleaseWrite();
             path = &(path[strlen(path)+1]);
         }
         int sector = dir->Find(path);
@@ -409,21 +410,21 @@ FileSystem::Remove(const char *name, FileHeader *hdr, int hsector)
 
         FileHeader *fileH = nullptr;
         #ifdef FILESYS
-            Lock *l = fileSystem->GetLock(sector);
-            if(!l->IsHeldByCurrentThread())
-                l->Acquire();
+            RWLock *l = fileSystem->GetLock(sector);
+            if(!l->IsHeldByCurrentThread() && !l->IsReadByCurrentThread())
+                l->AcquireWrite();
             if(openFileList->HasKey(sector)) { 
                 ///> If the file is still opened by other process we do not remove it from disk yet
                 ///> but we mark it with [removed] and remove its name from the directory.
                 DEBUG('h', "Remove requested by %s but file %s still opened by "
                             "other processes, removing from directory.\n", currentThread->GetName(), name);
-                fileH = openFileList->GetByKey(sector);
+                fileH = openFileList->Get(sector);
                 fileH->removed = true;
                 dir->Remove(path);
                 dir->WriteBack(d);    // Flush to disk.   
             }
             if(l->IsHeldByCurrentThread())
-                l->Release(); 
+                l->ReleaseWrite(); 
         #endif
 
         if(fileH == nullptr) { // File no opened, we remove from disk and directory
@@ -466,7 +467,7 @@ FileSystem::Remove(const char *name, FileHeader *hdr, int hsector)
         }
         DEBUG('h', "Queriendo sacar sector %d\n",hsector);
         ASSERT(openFileList->HasKey(hsector));
-        openFileList->RemoveByKey(hsector);
+        openFileList->Remove(hsector);
         hdr->ReleaseLock();
         delete hdr;
     #endif
@@ -482,7 +483,7 @@ FileSystem::List(char *name)
 {
     Directory *dir = new Directory(NUM_DIR_ENTRIES);
     //TakeLock();
-    dir->FetchFrom(directoryFile);
+    dir->FetchFrom(directoryFile, true);
     if(name == nullptr){
         dir->List();
     }
@@ -493,20 +494,20 @@ FileSystem::List(char *name)
         }
         else{
             FileHeader *hdr = nullptr;
-            Lock *l = fileSystem->GetLock(sector);
-            if(!l->IsHeldByCurrentThread())
-                l->Acquire();
+            RWLock *l = fileSystem->GetLock(sector);
+            if(!l->IsHeldByCurrentThread() && !l->IsReadByCurrentThread())
+                l->AcquireWrite();
             if(openFileList->HasKey(sector)) {
-                hdr = openFileList->GetByKey(sector);
+                hdr = openFileList->Get(sector);
         } else {
             hdr = new FileHeader;
             hdr->FetchFrom(sector);
-            openFileList->AppendKey(hdr, sector);
+            openFileList->Add(sector, hdr);
         }
         OpenFile *d = new OpenFile(sector, hdr);
-        dir->FetchFrom(d);
+        dir->FetchFrom(d, true);
         if(l->IsHeldByCurrentThread())
-            l->Release(); 
+            l->ReleaseWrite(); 
         dir->List();
         delete d;
         }
@@ -755,11 +756,14 @@ FileSystem::ReleaseLock() {
         lockFS->Release();
 }
 
-Lock *
+RWLock *
 FileSystem::GetLock(int sector) {
     TakeLock();
     if(locksSector[sector] == nullptr){
-        locksSector[sector] = new Lock("Directory lock");
+        // Named after the sector, to tell them apart in `-lp` reports.
+        char name[16];
+        snprintf(name, sizeof name, "sector %d", sector);
+        locksSector[sector] = new RWLock(name);
     }
     ReleaseLock();
     return locksSector[sector];
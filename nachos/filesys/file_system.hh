@@ -105,7 +105,7 @@ static const unsigned DIRECTORY_FILE_SIZE
 static const unsigned FREE_MAP_SECTOR = 0;
 
 
-class Lock;
+class RWLock;
 class FileSystem {
 public:
 
@@ -147,7 +147,7 @@ public:
 
     void ChangeDirectory(const char *name);
 
-    Lock* GetLock(int sector);
+    RWLock* GetLock(int sector);
 
 private:
     OpenFile *freeMapFile;  ///< Bit map of free disk blocks, represented as a
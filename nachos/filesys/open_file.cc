@@ -141,13 +141,14 @@ OpenFile::ReadAt(char *into, unsigned numBytes, unsigned position)
 {
     ASSERT(into != nullptr);
     ASSERT(numBytes > 0);
-    hdr->TakeLock();
+    hdr->TakeLock(true);  // Readers of the file need not wait for each other.
     unsigned fileLength = hdr->FileLength();
     unsigned firstSector, lastSector, numSectors;
     char *buf;
 
     if (position >= fileLength) {
         DEBUG('e', "position %d, fileLength %d \n", position, fileLength);
+        hdr->ReleaseLock();
         return 0;  // Check request.
     }
     if (position + numBytes > fileLength) {
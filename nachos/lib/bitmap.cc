@@ -10,10 +10,17 @@
 #include "bitmap.hh"
 #ifdef FILESYS
 #include "threads/system.hh"
+#include "threads/rw_lock.hh"
 #endif
 #include <stdio.h>
 
 
+#ifdef FILESYS
+/// Cursor of the free map, kept between the times it is fetched, so that
+/// allocations go on from where the last one stopped.
+static unsigned freeMapCursor = 0;
+#endif
+
 /// Initialize a bitmap with `nitems` bits, so that every bit is clear.  It
 /// can be added somewhere on a list.
 ///
@@ -25,9 +32,10 @@ Bitmap::Bitmap(unsigned nitems)
     numBits  = nitems;
     numWords = DivRoundUp(numBits, BITS_IN_WORD);
     map      = new unsigned [numWords];
-    for (unsigned i = 0; i < numBits; i++) {
-        Clear(i);
+    for (unsigned i = 0; i < numWords; i++) {
+        map[i] = 0;
     }
+    cursor   = 0;
 }
 
 /// De-allocate a bitmap.
@@ -69,20 +77,104 @@ Bitmap::Test(unsigned which) const
     return map[which / BITS_IN_WORD] & 1 << which % BITS_IN_WORD;
 }
 
-/// Return the number of the first bit which is clear.  As a side effect, set
-/// the bit (mark it as in use).  (In other words, find and allocate a bit.)
+int
+Bitmap::NextClear(unsigned from, unsigned to) const
+{
+    ASSERT(to <= numBits);
+
+    if (from >= to) {
+        return -1;
+    }
+    unsigned w = from / BITS_IN_WORD;
+    unsigned bits = ~map[w] & ~0U << from % BITS_IN_WORD;
+    while (bits == 0) {
+        if (++w * BITS_IN_WORD >= to) {
+            return -1;
+        }
+        bits = ~map[w];
+    }
+    unsigned i = w * BITS_IN_WORD + __builtin_ctz(bits);
+    return i < to ? (int) i : -1;
+}
+
+int
+Bitmap::NextSet(unsigned from, unsigned to) const
+{
+    ASSERT(to <= numBits);
+
+    if (from >= to) {
+        return -1;
+    }
+    unsigned w = from / BITS_IN_WORD;
+    unsigned bits = map[w] & ~0U << from % BITS_IN_WORD;
+    while (bits == 0) {
+        if (++w * BITS_IN_WORD >= to) {
+            return -1;
+        }
+        bits = map[w];
+    }
+    unsigned i = w * BITS_IN_WORD + __builtin_ctz(bits);
+    return i < to ? (int) i : -1;
+}
+
+int
+Bitmap::FindRun(unsigned n, unsigned from, unsigned to) const
+{
+    int start = NextClear(from, to);
+    while (start != -1 && start + n <= to) {
+        int set = NextSet(start, start + n);
+        if (set == -1) {
+            return start;
+        }
+        start = NextClear(set, to);
+    }
+    return -1;
+}
+
+/// Return the number of the first bit which is clear, starting from the
+/// cursor and wrapping around.  As a side effect, set the bit (mark it as
+/// in use).  (In other words, find and allocate a bit.)
 ///
 /// If no bits are clear, return -1.
 int
 Bitmap::Find()
 {
-    for (unsigned i = 0; i < numBits; i++) {
-        if (!Test(i)) {
+    int i = NextClear(cursor, numBits);
+    if (i == -1) {
+        i = NextClear(0, cursor);
+    }
+    if (i != -1) {
+        Mark(i);
+        cursor = (i + 1) % numBits;
+    }
+    return i;
+}
+
+/// Return the number of the first of `n` clear bits in a row, starting from
+/// the cursor and wrapping around, and set all of them.
+///
+/// If there are not as many clear bits in a row, return -1.
+int
+Bitmap::FindContiguous(unsigned n)
+{
+    ASSERT(n > 0);
+
+    if (n > numBits) {
+        return -1;
+    }
+    int first = FindRun(n, cursor, numBits);
+    if (first == -1) {
+        // A run may go across the cursor, so look up to its end.
+        unsigned to = cursor + n - 1 < numBits ? cursor + n - 1 : numBits;
+        first = FindRun(n, 0, to);
+    }
+    if (first != -1) {
+        for (unsigned i = first; i < first + n; i++) {
             Mark(i);
-            return i;
         }
+        cursor = (first + n) % numBits;
     }
-    return -1;
+    return first;
 }
 
 /// Return the number of clear bits in the bitmap.  (In other words, how many
@@ -92,10 +184,13 @@ Bitmap::CountClear() const
 {
     unsigned count = 0;
 
-    for (unsigned i = 0; i < numBits; i++) {
-        if (!Test(i)) {
-            count++;
+    for (unsigned w = 0; w < numWords; w++) {
+        unsigned bits = ~map[w];
+        if (w == numWords - 1 && numBits % BITS_IN_WORD != 0) {
+            // Leave out the bits past the end.
+            bits &= (1U << numBits % BITS_IN_WORD) - 1;
         }
+        count += __builtin_popcount(bits);
     }
     return count;
 }
@@ -108,10 +203,8 @@ void
 Bitmap::Print() const
 {
     printf("Bitmap bits set:\n");
-    for (unsigned i = 0; i < numBits; i++) {
-        if (Test(i)) {
-            printf("%u ", i);
-        }
+    for (int i = NextSet(0, numBits); i != -1; i = NextSet(i + 1, numBits)) {
+        printf("%d ", i);
     }
     printf("\n");
 }
@@ -129,6 +222,9 @@ Bitmap::FetchFrom(OpenFile *file)
 #endif
     ASSERT(file != nullptr);
     file->ReadAt((char *) map, numWords * sizeof (unsigned), 0);
+#ifdef FILESYS
+    cursor = freeMapCursor % numBits;
+#endif
 }
 
 /// Store the contents of a bitmap to a Nachos file.
@@ -142,6 +238,7 @@ Bitmap::WriteBack(OpenFile *file)
     ASSERT(file != nullptr);
     file->WriteAt((char *) map, numWords * sizeof (unsigned), 0);
 #ifdef FILESYS
+    freeMapCursor = cursor;
     BMReleaseLock();
 #endif
 }
@@ -149,15 +246,15 @@ Bitmap::WriteBack(OpenFile *file)
 #ifdef FILESYS
 void
 Bitmap::BMTakeLock() {
-    Lock *lock = fileSystem->GetLock(FREE_MAP_SECTOR);
+    RWLock *lock = fileSystem->GetLock(FREE_MAP_SECTOR);
     if(!lock->IsHeldByCurrentThread()) /// Prevent double release
-        lock->Acquire();
+        lock->AcquireWrite();
 }
 
 void
 Bitmap::BMReleaseLock() {
-    Lock *lock = fileSystem->GetLock(FREE_MAP_SECTOR);
+    RWLock *lock = fileSystem->GetLock(FREE_MAP_SECTOR);
     if(lock->IsHeldByCurrentThread()) /// Prevent double release
-        lock->Release();
+        lock->ReleaseWrite();
 }
 #endif
\ No newline at end of file
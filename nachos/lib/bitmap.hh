@@ -51,9 +51,21 @@ public:
 
     /// Return the index of a clear bit, and as a side effect, set the bit.
     ///
+    /// The search starts where the last one stopped and wraps around (“next
+    /// fit”), so that bits freed behind the cursor are not taken again
+    /// right away, and each search does not walk over the bits taken
+    /// before.
+    ///
     /// If no bits are clear, return -1.
     int Find();
 
+    /// Return the index of the first of `n` consecutive clear bits, and as
+    /// a side effect, set them.  The search starts at the cursor, like
+    /// `Find`.
+    ///
+    /// If there is no such run of bits, return -1 and set none.
+    int FindContiguous(unsigned n);
+
     /// Return the number of clear bits.
     unsigned CountClear() const;
 
@@ -78,6 +90,15 @@ public:
 #endif
 private:
 
+    /// Index of the first clear (or set) bit in `[from, to)`, or -1 if there
+    /// is none.  They look at a word at a time.
+    int NextClear(unsigned from, unsigned to) const;
+    int NextSet(unsigned from, unsigned to) const;
+
+    /// Index of the first of `n` clear bits in a row within `[from, to)`,
+    /// or -1.
+    int FindRun(unsigned n, unsigned from, unsigned to) const;
+
     /// Number of bits in the bitmap.
     unsigned numBits;
 
@@ -88,6 +109,10 @@ private:
     /// Bit storage.
     unsigned *map;
 
+    /// Where `Find` and `FindContiguous` start looking.  The free map of
+    /// the disk keeps it from one fetch to the next.
+    unsigned cursor;
+
 };
 
 
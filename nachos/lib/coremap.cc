@@ -6,61 +6,110 @@ Coremap::Coremap(unsigned nitems)
     ASSERT(nitems > 0);
 
     numItems       = nitems;
-    bitmap         = new Bitmap(nitems);
-    virtualPage    = new unsigned [nitems];
-    proccessID     = new unsigned [nitems];
-    #ifdef PRPOLICY_FIFO
-    fifoPointer  = 0;
-    #endif
+    frames         = new Frame [nitems];
+    // Link free frames in order, so that they are first taken in order.
+    for (unsigned i = 0; i < nitems; i++) {
+        frames[i].owner = nullptr;
+        frames[i].proccessID = -1;
+        frames[i].virtualPage = -1;
+        frames[i].pinCount = 0;
+        frames[i].inUse = false;
+        frames[i].nextFree = i + 1 < nitems ? (int) i + 1 : -1;
+    }
+    firstFree      = 0;
+    numFree        = nitems;
+    fifoPointer    = 0;
 }
 
 Coremap::~Coremap()
 {
-    delete bitmap;
-    delete [] virtualPage;
-    delete [] proccessID;
+    delete [] frames;
 }
 
 void
-Coremap::Mark(unsigned which, unsigned vPage)
+Coremap::Mark(unsigned which, AddressSpace *owner, unsigned vPage)
 {
-    bitmap->Mark(which);
-    virtualPage[which] = vPage;
-    proccessID[which] = currentThread->sid;
+    ASSERT(which < numItems);
+    ASSERT(frames[which].inUse);
+    frames[which].owner = owner;
+    frames[which].virtualPage = vPage;
+    frames[which].proccessID = currentThread->sid;
 }
 
 void
 Coremap::Clear(unsigned which)
 {
-    bitmap->Clear(which);
-    virtualPage[which] = -1;
-    proccessID[which] = -1;
+    ASSERT(which < numItems);
+    ASSERT(frames[which].inUse);
+    ASSERT(frames[which].pinCount == 0);
+    frames[which].owner = nullptr;
+    frames[which].virtualPage = -1;
+    frames[which].proccessID = -1;
+    frames[which].inUse = false;
+    frames[which].nextFree = firstFree;
+    firstFree = which;
+    numFree++;
 }
 
 int
-Coremap::Find(unsigned vPage)
-{
-    int pp = bitmap->Find();
-    if (pp == -1) return -1;
-    else {
-        virtualPage[pp] = vPage;
-        proccessID[pp] = currentThread->sid;
-        return pp;
-    }
+Coremap::Find(AddressSpace *owner, unsigned vPage)
+{
+    if (firstFree == -1) return -1;
+    int pp = firstFree;
+    firstFree = frames[pp].nextFree;
+    numFree--;
+    frames[pp].inUse = true;
+    Mark(pp, owner, vPage);
+    return pp;
 }
 
 unsigned
 Coremap::VirtualPage(unsigned which)
 {
-    ASSERT(bitmap->Test(which));
-    return virtualPage[which];
+    ASSERT(which < numItems && frames[which].inUse);
+    return frames[which].virtualPage;
 }
 
 unsigned
 Coremap::ProccessID(unsigned which)
 {
-    ASSERT(bitmap->Test(which));
-    return proccessID[which];
+    ASSERT(which < numItems && frames[which].inUse);
+    return frames[which].proccessID;
+}
+
+AddressSpace *
+Coremap::Owner(unsigned which)
+{
+    ASSERT(which < numItems && frames[which].inUse);
+    return frames[which].owner;
+}
+
+bool
+Coremap::InUse(unsigned which)
+{
+    ASSERT(which < numItems);
+    return frames[which].inUse;
+}
+
+void
+Coremap::Pin(unsigned which)
+{
+    ASSERT(which < numItems && frames[which].inUse);
+    frames[which].pinCount++;
+}
+
+void
+Coremap::Unpin(unsigned which)
+{
+    ASSERT(which < numItems && frames[which].pinCount > 0);
+    frames[which].pinCount--;
+}
+
+bool
+Coremap::IsPinned(unsigned which)
+{
+    ASSERT(which < numItems);
+    return frames[which].pinCount > 0;
 }
 
 unsigned
@@ -69,6 +118,12 @@ Coremap::NumItems()
     return numItems;
 }
 
+unsigned
+Coremap::NumFree()
+{
+    return numFree;
+}
+
 unsigned
 Coremap::NextFIFOPointer()
 {
@@ -82,4 +137,3 @@ Coremap::UpdateFIFOPointer(unsigned pointer)
 {
     fifoPointer = (pointer + 1) % numItems;
 }
-
@@ -1,28 +1,44 @@
+/// The coremap: which page of which address space each physical page (or
+/// frame) holds.
+///
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
 #ifndef NACHOS_LIB_COREMAP__HH
 #define NACHOS_LIB_COREMAP__HH
 
-#include "bitmap.hh"
 
+class AddressSpace;
+
+/// Everything about a frame is kept in one entry of a single array, so
+/// that finding the owner of a victim does not go through the process
+/// table.  Free frames are linked through their entries, so taking one and
+/// giving it back take constant time.
+///
+/// A frame can be pinned while the kernel moves a page into or out of it,
+/// so that page replacement does not pick it in the meantime.
 class Coremap {
 public:
 
-    /// Initialize a coremap with `nitems` items;
+    /// Initialize a coremap with `nitems` free frames.
     Coremap(unsigned nitems);
 
     /// Uninitialize a coremap.
     ~Coremap();
 
-    /// Set the “nth” bit of the bitmap and the coresponding virtual page.
-    void Mark(unsigned which, unsigned vPage);
+    /// Give frame `which`, in use, to page `vPage` of `owner`, which belongs
+    /// to the current process.
+    void Mark(unsigned which, AddressSpace *owner, unsigned vPage);
 
-    /// Clear the “nth” bit of the bitmap.
+    /// Free frame `which`.
     void Clear(unsigned which);
 
-    /// Return the index of a clear bit in the bitmap, and as a side effect,
-    /// set the bit, the current process ID, and the corresponding virtual page.
+    /// Take a free frame for page `vPage` of `owner`, which belongs to the
+    /// current process.
     ///
-    /// If no bits are clear, return -1.
-    int Find(unsigned vPage);
+    /// If no frames are free, return -1.
+    int Find(AddressSpace *owner, unsigned vPage);
 
     /// Return virtual page number
     unsigned VirtualPage(unsigned which);
@@ -30,23 +46,46 @@ public:
     /// Return proccess id
     unsigned ProccessID(unsigned which);
 
+    /// Address space the page in frame `which` belongs to.
+    AddressSpace *Owner(unsigned which);
+
+    /// Does frame `which` hold some page?
+    bool InUse(unsigned which);
+
+    /// Pins can nest: a frame is pinned until it is unpinned as many times
+    /// as it was pinned.
+    void Pin(unsigned which);
+    void Unpin(unsigned which);
+    bool IsPinned(unsigned which);
+
     /// Return numItems
     unsigned NumItems();
 
+    /// Number of free frames.
+    unsigned NumFree();
+
     unsigned NextFIFOPointer();
     void UpdateFIFOPointer(unsigned pointer);
 private:
 
+    struct Frame {
+        AddressSpace *owner;
+        unsigned proccessID;   ///< Process of `owner`, for its swap file.
+        unsigned virtualPage;
+        unsigned pinCount;
+        bool inUse;
+        int nextFree;          ///< Next free frame, if this one is free.
+    };
+
     unsigned fifoPointer;
 
     unsigned numItems;
 
-    Bitmap *bitmap;
-
-
-    unsigned *virtualPage;
+    Frame *frames;
 
-    unsigned *proccessID;
+    /// Free frames, linked through `nextFree`.
+    int firstFree;
+    unsigned numFree;
 
 };
 
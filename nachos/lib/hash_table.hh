@@ -0,0 +1,211 @@
+/// A map from integer keys to some type, with lookups in constant time.
+///
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+#ifndef NACHOS_LIB_HASHTABLE__HH
+#define NACHOS_LIB_HASHTABLE__HH
+
+
+#include "list.hh"
+
+
+/// Buckets a table starts with; it doubles them whenever it has more items
+/// than buckets.
+const unsigned MIN_HASH_BUCKETS = 16;
+
+/// Keyed lookups of `List` (`HasKey`, `GetByKey`, `RemoveByKey`) walk the
+/// whole list.  This table hashes keys to buckets instead, each of them an
+/// `IntrusiveList` of entries, so that those operations take constant time
+/// on average.
+///
+/// Entries removed are kept for later additions instead of being freed,
+/// so a table whose number of items goes up and down allocates only while
+/// it grows beyond what it ever held.
+template <class T>
+class HashTable {
+public:
+
+    /// Construct an empty table.
+    HashTable();
+
+    ~HashTable();
+
+    /// Associate `item` with `key`, which must not have an item yet.
+    void Add(int key, T item);
+
+    /// Get the item associated with `key`, or `T()` if there is none.
+    T Get(int key) const;
+
+    /// Check whether `key` has an associated item.
+    bool HasKey(int key) const;
+
+    /// Remove the item associated with `key`.
+    ///
+    /// Returns the removed item, or `T()` if there was none.
+    T Remove(int key);
+
+    bool IsEmpty() const;
+
+    unsigned Size() const;
+
+private:
+
+    struct Entry {
+        int key;
+        T item;
+        IntrusiveLink<Entry> link;
+    };
+
+    typedef IntrusiveList<Entry, &Entry::link> Bucket;
+
+    unsigned BucketOf(int key) const;
+
+    /// Entry for `key`, or null if there is none.
+    Entry *Find(int key) const;
+
+    /// Double the number of buckets, moving entries to their new ones.
+    void Grow();
+
+    Bucket *buckets;
+    unsigned numBuckets;  ///< Always a power of two.
+    unsigned bucketBits;  ///< Base 2 logarithm of `numBuckets`.
+    unsigned size;
+
+    /// Entries not in use.
+    Bucket spare;
+};
+
+template <class T>
+HashTable<T>::HashTable()
+{
+    numBuckets = MIN_HASH_BUCKETS;
+    bucketBits = 0;
+    while (1U << bucketBits < numBuckets) {
+        bucketBits++;
+    }
+    buckets = new Bucket [numBuckets];
+    size = 0;
+}
+
+template <class T>
+HashTable<T>::~HashTable()
+{
+    for (unsigned i = 0; i < numBuckets; i++) {
+        while (!buckets[i].IsEmpty()) {
+            delete buckets[i].Pop();
+        }
+    }
+    delete [] buckets;
+    while (!spare.IsEmpty()) {
+        delete spare.Pop();
+    }
+}
+
+template <class T>
+unsigned
+HashTable<T>::BucketOf(int key) const
+{
+    // Multiplicative hashing, so that keys close to each other (as sectors
+    // of files created together are) spread over all buckets.  The highest
+    // bits of the product are the best mixed, so the bucket is taken from
+    // them.
+    return ((unsigned) key * 2654435769U) >> (32 - bucketBits);
+}
+
+template <class T>
+typename HashTable<T>::Entry *
+HashTable<T>::Find(int key) const
+{
+    Bucket *bucket = &buckets[BucketOf(key)];
+    for (Entry *e = bucket->Head(); e != nullptr; e = Bucket::Next(e)) {
+        if (e->key == key) {
+            return e;
+        }
+    }
+    return nullptr;
+}
+
+template <class T>
+void
+HashTable<T>::Grow()
+{
+    Bucket *old = buckets;
+    unsigned oldNumBuckets = numBuckets;
+
+    numBuckets *= 2;
+    bucketBits++;
+    buckets = new Bucket [numBuckets];
+    for (unsigned i = 0; i < oldNumBuckets; i++) {
+        while (!old[i].IsEmpty()) {
+            Entry *e = old[i].Pop();
+            buckets[BucketOf(e->key)].Append(e);
+        }
+    }
+    delete [] old;
+}
+
+template <class T>
+void
+HashTable<T>::Add(int key, T item)
+{
+    ASSERT(Find(key) == nullptr);
+
+    if (size == numBuckets) {
+        Grow();
+    }
+    Entry *e = spare.IsEmpty() ? new Entry : spare.Pop();
+    e->key = key;
+    e->item = item;
+    buckets[BucketOf(key)].Append(e);
+    size++;
+}
+
+template <class T>
+T
+HashTable<T>::Get(int key) const
+{
+    Entry *e = Find(key);
+    return e != nullptr ? e->item : T();
+}
+
+template <class T>
+bool
+HashTable<T>::HasKey(int key) const
+{
+    return Find(key) != nullptr;
+}
+
+template <class T>
+T
+HashTable<T>::Remove(int key)
+{
+    Entry *e = Find(key);
+    if (e == nullptr) {
+        return T();
+    }
+    T item = e->item;
+    buckets[BucketOf(key)].Remove(e);
+    e->item = T();
+    spare.Prepend(e);
+    size--;
+    return item;
+}
+
+template <class T>
+bool
+HashTable<T>::IsEmpty() const
+{
+    return size == 0;
+}
+
+template <class T>
+unsigned
+HashTable<T>::Size() const
+{
+    return size;
+}
+
+
+#endif
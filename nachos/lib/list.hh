@@ -420,4 +420,176 @@ List<Item>::RemoveByKey(int key)
 }
 
 
+/// Links kept inside an item so that it can be on an `IntrusiveList`.
+///
+/// An item can be on as many intrusive lists at once as links it has, but
+/// on only one list through each link.
+template <class T>
+class IntrusiveLink {
+public:
+
+    IntrusiveLink();
+
+    T *prev;  ///< Previous item on the list, null if this is the first.
+    T *next;  ///< Next item on the list, null if this is the last.
+};
+
+/// The following class defines an “intrusive list” -- a doubly linked list
+/// of items of type `T` that are linked through their member `LINK`.
+///
+/// Unlike `List`, putting items on the list or taking them off allocates
+/// nothing, and removing a given item takes constant time.  In turn, items
+/// are pointers to `T`, and the list does not own them: they must stay
+/// alive while they are on it.
+template <class T, IntrusiveLink<T> T::*LINK>
+class IntrusiveList {
+public:
+
+    /// Initialize the list, empty.
+    IntrusiveList();
+
+    /// Put `item` at the beginning of the list.
+    void Prepend(T *item);
+
+    /// Put `item` at the end of the list.
+    void Append(T *item);
+
+    /// Take `item`, which must be on the list, off it.
+    void Remove(T *item);
+
+    /// Take the first item off the list.
+    ///
+    /// Returns it, or null if the list is empty.
+    T *Pop();
+
+    /// First item of the list, null if it is empty.
+    T *Head() const;
+
+    /// Item after `item` on the list, null if it is the last.
+    static T *Next(const T *item);
+
+    bool IsEmpty() const;
+
+    unsigned Size() const;
+
+private:
+
+    T *first;  ///< Head of the list, null if list is empty.
+    T *last;   ///< Last item of list.
+    unsigned size;
+};
+
+template <class T>
+IntrusiveLink<T>::IntrusiveLink()
+{
+    prev = next = nullptr;
+}
+
+template <class T, IntrusiveLink<T> T::*LINK>
+IntrusiveList<T, LINK>::IntrusiveList()
+{
+    first = last = nullptr;
+    size = 0;
+}
+
+template <class T, IntrusiveLink<T> T::*LINK>
+void
+IntrusiveList<T, LINK>::Prepend(T *item)
+{
+    ASSERT(item != nullptr);
+
+    (item->*LINK).prev = nullptr;
+    (item->*LINK).next = first;
+    if (first == nullptr) {
+        last = item;
+    } else {
+        (first->*LINK).prev = item;
+    }
+    first = item;
+    size++;
+}
+
+template <class T, IntrusiveLink<T> T::*LINK>
+void
+IntrusiveList<T, LINK>::Append(T *item)
+{
+    ASSERT(item != nullptr);
+
+    (item->*LINK).prev = last;
+    (item->*LINK).next = nullptr;
+    if (last == nullptr) {
+        first = item;
+    } else {
+        (last->*LINK).next = item;
+    }
+    last = item;
+    size++;
+}
+
+template <class T, IntrusiveLink<T> T::*LINK>
+void
+IntrusiveList<T, LINK>::Remove(T *item)
+{
+    ASSERT(item != nullptr);
+    ASSERT(size > 0);
+
+    IntrusiveLink<T> *link = &(item->*LINK);
+    if (link->prev == nullptr) {
+        ASSERT(first == item);
+        first = link->next;
+    } else {
+        (link->prev->*LINK).next = link->next;
+    }
+    if (link->next == nullptr) {
+        ASSERT(last == item);
+        last = link->prev;
+    } else {
+        (link->next->*LINK).prev = link->prev;
+    }
+    link->prev = link->next = nullptr;
+    size--;
+}
+
+template <class T, IntrusiveLink<T> T::*LINK>
+T *
+IntrusiveList<T, LINK>::Pop()
+{
+    T *item = first;
+    if (item != nullptr) {
+        Remove(item);
+    }
+    return item;
+}
+
+template <class T, IntrusiveLink<T> T::*LINK>
+T *
+IntrusiveList<T, LINK>::Head() const
+{
+    return first;
+}
+
+template <class T, IntrusiveLink<T> T::*LINK>
+T *
+IntrusiveList<T, LINK>::Next(const T *item)
+{
+    ASSERT(item != nullptr);
+
+    return (item->*LINK).next;
+}
+
+template <class T, IntrusiveLink<T> T::*LINK>
+bool
+IntrusiveList<T, LINK>::IsEmpty() const
+{
+    return first == nullptr;
+}
+
+template <class T, IntrusiveLink<T> T::*LINK>
+unsigned
+IntrusiveList<T, LINK>::Size() const
+{
+    return size;
+}
+
+
 #endif
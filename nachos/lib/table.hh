@@ -1,5 +1,8 @@
 /// A very simple map from non-negative integers to some type.
 ///
+/// The integers are handed out by the table itself, as process and file
+/// identifiers are.
+///
 /// Copyright (c) 2018-2021 Docentes de la Universidad Nacional de Rosario.
 /// All rights reserved.  See `copyright.h` for copyright notice and
 /// limitation of liability and disclaimer of warranty provisions.
@@ -8,16 +11,35 @@
 #define NACHOS_LIB_TABLE__HH
 
 
-#include "list.hh"
+#include "utility.hh"
+
+
+/// Bits of an index that tell its slot.  In tables with generations, the
+/// others tell how many times the slot had been taken before, so that an
+/// index kept after its item was removed does not stand for whatever item
+/// takes the slot next.
+const unsigned TABLE_SLOT_BITS = 16;
 
+/// The table grows up to this many slots.
+const unsigned TABLE_MAX_SIZE = 1 << TABLE_SLOT_BITS;
+
+/// Generations an index can tell apart, so that indexes stay positive.
+const unsigned TABLE_GENERATIONS = 1U << (31 - TABLE_SLOT_BITS);
 
 template <class T>
 class Table {
 public:
-    static const unsigned SIZE = 20;
+    /// Slots a table starts with; it doubles them whenever they are full.
+    static const unsigned INITIAL_SIZE = 16;
 
     /// Construct an empty table.
-    Table();
+    ///
+    /// Indexes are the slots themselves, small and reused as soon as they
+    /// are freed, unless `generations` is set; then they also tell how many
+    /// times their slot was taken, as process identifiers do.
+    Table(bool generations = false);
+
+    ~Table();
 
     /// Add an item into a free index.
     ///
@@ -47,104 +69,167 @@ public:
     T Update(int i, T item);
 
 private:
-    /// Data items.
-    T data[SIZE];
+    struct Slot {
+        T item;
+        unsigned generation;  ///< Times the slot has been taken and freed.
+        bool used;
+        int nextFree;         ///< Next free slot, if this one is free.
+    };
+
+    /// Slot of index `i` if the index is still valid, or -1.
+    int SlotOf(int i) const;
+
+    /// Bits above `TABLE_SLOT_BITS` of the index of slot `s`.
+    unsigned GenerationOf(unsigned s) const;
+
+    /// Double the slots.
+    void Grow();
+
+    /// Data items, and whether each slot holds one.
+    Slot *slots;
+    unsigned size;
+
+    /// Slots ever used; those from `current` on have never been taken.
+    unsigned current;
 
-    /// Current greatest index for a new item.
-    int current;
+    /// Items in the table.
+    unsigned count;
 
-    /// A list to store indexes of items that have been freed and are not
-    /// among those with greatest numbers, so it is not possible to modify
-    /// `current`.  In other words, this keeps track of external
-    /// fragmentation.
-    List<int> freed;
+    bool generations;  ///< Whether indexes tell the generation of a slot.
+
+    /// Slots that have been freed, linked through `nextFree`, most recently
+    /// freed first.
+    int firstFree;
 };
 
 
 template <class T>
-Table<T>::Table()
+Table<T>::Table(bool generations_)
+{
+    generations = generations_;
+    size = INITIAL_SIZE;
+    slots = new Slot [size];
+    current = count = 0;
+    firstFree = -1;
+}
+
+template <class T>
+Table<T>::~Table()
 {
-    current = 0;
+    delete [] slots;
 }
 
+template <class T>
+void
+Table<T>::Grow()
+{
+    Slot *old = slots;
+    slots = new Slot [size * 2];
+    for (unsigned i = 0; i < current; i++) {
+        slots[i] = old[i];
+    }
+    size *= 2;
+    delete [] old;
+}
 
 template <class T>
 int
 Table<T>::Add(T item)
 {
-    int i;
-
-    if (!freed.IsEmpty()) {
-        i = freed.Pop();
-        data[i] = item;
-        return i;
-    } else if (current < static_cast<int>(SIZE)) {
-        i = current++;
-        data[i] = item;
-        return i;
+    unsigned s;
+
+    if (firstFree != -1) {
+        s = firstFree;
+        firstFree = slots[s].nextFree;
+    } else if (current < size || size < TABLE_MAX_SIZE) {
+        if (current == size) {
+            Grow();
+        }
+        s = current++;
+        slots[s].generation = 0;
     } else {
         return -1;
     }
+    slots[s].item = item;
+    slots[s].used = true;
+    count++;
+
+    return GenerationOf(s) << TABLE_SLOT_BITS | s;
+}
+
+template <class T>
+unsigned
+Table<T>::GenerationOf(unsigned s) const
+{
+    return generations ? slots[s].generation % TABLE_GENERATIONS : 0;
+}
+
+template <class T>
+int
+Table<T>::SlotOf(int i) const
+{
+    if (i < 0) {
+        return -1;
+    }
+    unsigned s = i % TABLE_MAX_SIZE;
+    unsigned generation = (unsigned) i >> TABLE_SLOT_BITS;
+    if (s >= current || !slots[s].used
+          || GenerationOf(s) != generation) {
+        return -1;
+    }
+    return s;
 }
 
 template <class T>
 T
 Table<T>::Get(int i) const
 {
-    ASSERT(i >= 0);
-
-    return HasKey(i) ? data[i] : T();
+    int s = SlotOf(i);
+    return s != -1 ? slots[s].item : T();
 }
 
 template <class T>
 bool
 Table<T>::HasKey(int i) const
 {
-    ASSERT(i >= 0);
-
-    return i < current && !freed.Has(i);
+    return SlotOf(i) != -1;
 }
 
 template <class T>
 bool
 Table<T>::IsEmpty() const
 {
-    return current == 0;
+    return count == 0;
 }
 
 template <class T>
 T
 Table<T>::Remove(int i)
 {
-    ASSERT(i >= 0);
-
-    if (!HasKey(i)) {
+    int s = SlotOf(i);
+    if (s == -1) {
         return T();
     }
 
-    if (i == current - 1) {
-        current--;
-        for (int j = current - 1; j >= 0 && !HasKey(j); j--) {
-            ASSERT(freed.Has(j));
-            freed.Remove(j);
-            current--;
-        }
-    } else {
-        freed.SortedInsert(i, i);
-    }
-    return data[i];
+    T item = slots[s].item;
+    slots[s].item = T();
+    slots[s].used = false;
+    slots[s].generation++;
+    slots[s].nextFree = firstFree;
+    firstFree = s;
+    count--;
+    return item;
 }
 
 template <class T>
 T
 Table<T>::Update(int i, T item)
 {
-    ASSERT(i >= 0);
-    ASSERT(i < current);
-    ASSERT(!freed.Has(i));
+    int s = SlotOf(i);
+    ASSERT(s != -1);
 
-    T previous = data[i];
-    data[i] = item;
+    T previous = slots[s].item;
+    slots[s].item = item;
     return previous;
 }
 
@@ -0,0 +1,101 @@
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+
+#include "decode_cache.hh"
+#include "endianness.hh"
+#include "lib/assert.hh"
+#ifdef THREADED_CORE
+#include "machine.hh"
+#endif
+
+
+DecodeCache::DecodeCache(unsigned aNumPhysicalPages)
+{
+    numPhysicalPages = aNumPhysicalPages;
+    instructions = new Instruction [numPhysicalPages * WORDS_PER_PAGE];
+    decoded = new unsigned [numPhysicalPages];
+    trapping = new unsigned [numPhysicalPages];
+    delimited = new unsigned [numPhysicalPages];
+    for (unsigned i = 0; i < numPhysicalPages; i++) {
+        decoded[i]   = 0;
+        trapping[i]  = 0;
+        delimited[i] = 0;
+    }
+    blockLength = new unsigned char [numPhysicalPages * WORDS_PER_PAGE];
+}
+
+DecodeCache::~DecodeCache()
+{
+    delete [] instructions;
+    delete [] decoded;
+    delete [] trapping;
+    delete [] delimited;
+    delete [] blockLength;
+}
+
+const Instruction *
+DecodeCache::Lookup(unsigned physAddr, const char *memory)
+{
+    ASSERT(physAddr % 4 == 0);
+    ASSERT(memory != nullptr);
+
+    unsigned frame = physAddr / PAGE_SIZE;
+    unsigned bit   = 1U << (physAddr % PAGE_SIZE / 4);
+    ASSERT(frame < numPhysicalPages);
+
+    Instruction *instr = &instructions[physAddr / 4];
+    if (!(decoded[frame] & bit)) {
+        instr->value = WordToHost(*(const unsigned *) &memory[physAddr]);
+        instr->Decode();
+#ifdef THREADED_CORE
+        instr->handler = Machine::ThreadedHandler(instr->opCode);
+#endif
+        decoded[frame] |= bit;
+        if (instr->MayTrap()) {
+            trapping[frame] |= bit;
+        } else {
+            trapping[frame] &= ~bit;
+        }
+    }
+    return instr;
+}
+
+void
+DecodeCache::LookupBlock(unsigned physAddr, const char *memory, Block *block)
+{
+    ASSERT(physAddr % 4 == 0);
+    ASSERT(block != nullptr);
+
+    unsigned frame = physAddr / PAGE_SIZE;
+    unsigned slot  = physAddr % PAGE_SIZE / 4;
+    ASSERT(frame < numPhysicalPages);
+
+    if (!(delimited[frame] & 1U << slot)) {
+        // Walk forward until something that ends the block.  A branch
+        // drags its delay slot along, if it is in the same page.
+        unsigned end = slot;
+        while (end < WORDS_PER_PAGE) {
+            const Instruction *instr = Lookup(physAddr + (end - slot) * 4,
+                                              memory);
+            end++;
+            if (instr->IsBranch()) {
+                if (end < WORDS_PER_PAGE) {
+                    Lookup(physAddr + (end - slot) * 4, memory);
+                    end++;
+                }
+                break;
+            }
+            if (instr->IsStore()) {
+                break;
+            }
+        }
+        blockLength[physAddr / 4] = end - slot;
+        delimited[frame] |= 1U << slot;
+    }
+
+    block->first   = &instructions[physAddr / 4];
+    block->length  = blockLength[physAddr / 4];
+    block->mayTrap = trapping[frame] >> slot;
+}
@@ -0,0 +1,106 @@
+/// A cache of decoded instructions, tagged by physical address.
+///
+/// Decoding an instruction is pure work on the word stored in memory, so
+/// once a word has been decoded there is no need to do it again until the
+/// word changes.  The cache keeps one decoded `Instruction` per word of
+/// `mainMemory`, plus one bit per word telling whether that slot holds an
+/// up to date decoding.  All the bits of a physical page live in a single
+/// word, so forgetting everything known about a page is just clearing it.
+///
+/// On top of that, the cache remembers where the basic block starting at
+/// each word ends, so that the simulator can run a whole block per dispatch
+/// (see `Machine::RunBlock`).
+///
+/// Since the cache is physically tagged, it does not need to be flushed on
+/// context switches or TLB reloads; it only needs to know when the contents
+/// of a physical page change.  The MMU takes care of that for stores done
+/// by user programs; the kernel must call `MMU::InvalidateFrame` whenever
+/// it writes into `mainMemory` directly (for example when loading a page
+/// from the executable or from swap).
+///
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+#ifndef NACHOS_MACHINE_DECODECACHE__HH
+#define NACHOS_MACHINE_DECODECACHE__HH
+
+
+#include "instruction.hh"
+#include "mmu.hh"
+
+
+/// Number of instructions that fit in a physical page.
+const unsigned WORDS_PER_PAGE = PAGE_SIZE / 4;
+
+static_assert(WORDS_PER_PAGE <= 32,
+              "the decoded bits of a page must fit in one word");
+
+/// A run of consecutive instructions that, unless one of them raises an
+/// exception, always execute one after the other.
+///
+/// A block ends with a branch or jump and its delay slot, with a store (it
+/// may rewrite the code that follows), or at the end of a page.  Since all
+/// of its instructions are in the same page, they are also contiguous in
+/// the cache.
+struct Block {
+    const Instruction *first;  ///< The instructions of the block.
+    unsigned length;           ///< How many instructions there are.
+    unsigned mayTrap;          ///< Bit `i` is set if the `i`-th instruction
+                               ///< may raise an exception.
+};
+
+class DecodeCache {
+public:
+
+    /// Create an empty cache for `numPhysicalPages` pages of memory.
+    DecodeCache(unsigned numPhysicalPages);
+
+    ~DecodeCache();
+
+    /// Return the decoded form of the word at `physAddr` in `memory`,
+    /// decoding it first if it is not cached yet.
+    ///
+    /// `physAddr` must be word aligned.  The returned pointer stays valid
+    /// until the next lookup of the same slot.
+    const Instruction *Lookup(unsigned physAddr, const char *memory);
+
+    /// Return in `*block` the basic block that starts at `physAddr`,
+    /// decoding and delimiting it first if needed.
+    ///
+    /// The same rules as for `Lookup` apply.
+    void LookupBlock(unsigned physAddr, const char *memory, Block *block);
+
+    /// Forget every decoded instruction of physical page `frame`.
+    void InvalidateFrame(unsigned frame);
+
+private:
+
+    /// One decoded instruction per word of physical memory.
+    Instruction *instructions;
+
+    /// For each physical page, which of its words are decoded.
+    unsigned *decoded;
+
+    /// For each physical page, which of its decoded words may trap.
+    unsigned *trapping;
+
+    /// For each physical page, which of its words have `blockLength` set.
+    unsigned *delimited;
+
+    /// Length of the basic block starting at each word.
+    unsigned char *blockLength;
+
+    unsigned numPhysicalPages;
+};
+
+inline void
+DecodeCache::InvalidateFrame(unsigned frame)
+{
+    ASSERT(frame < numPhysicalPages);
+    decoded[frame]   = 0;
+    delimited[frame] = 0;
+}
+
+
+#endif
@@ -65,3 +65,82 @@ Instruction::RegFromType(RegType t) const
             return -1;
     }
 }
+
+bool
+Instruction::IsBranch() const
+{
+    switch (opCode) {
+        case OP_BEQ:
+        case OP_BGEZ:
+        case OP_BGEZAL:
+        case OP_BGTZ:
+        case OP_BLEZ:
+        case OP_BLTZ:
+        case OP_BLTZAL:
+        case OP_BNE:
+        case OP_J:
+        case OP_JAL:
+        case OP_JALR:
+        case OP_JR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool
+Instruction::IsStore() const
+{
+    switch (opCode) {
+        case OP_SB:
+        case OP_SH:
+        case OP_SW:
+        case OP_SWL:
+        case OP_SWR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool
+Instruction::MayTrap() const
+{
+    if (IsBranch()) {
+        return false;
+    }
+    switch (opCode) {
+        case OP_ADDIU:
+        case OP_ADDU:
+        case OP_AND:
+        case OP_ANDI:
+        case OP_DIV:
+        case OP_DIVU:
+        case OP_LUI:
+        case OP_MFHI:
+        case OP_MFLO:
+        case OP_MTHI:
+        case OP_MTLO:
+        case OP_MULT:
+        case OP_MULTU:
+        case OP_NOR:
+        case OP_OR:
+        case OP_ORI:
+        case OP_SLL:
+        case OP_SLLV:
+        case OP_SLT:
+        case OP_SLTI:
+        case OP_SLTIU:
+        case OP_SLTU:
+        case OP_SRA:
+        case OP_SRAV:
+        case OP_SRL:
+        case OP_SRLV:
+        case OP_SUBU:
+        case OP_XOR:
+        case OP_XORI:
+            return false;
+        default:
+            return true;
+    }
+}
@@ -25,6 +25,20 @@ public:
     /// Retrieve the register number referred to in an instruction.
     int RegFromType(RegType reg) const;
 
+    /// Is this a branch or a jump?  If so, the instruction that follows it
+    /// (its delay slot) is executed before control is transferred.
+    bool IsBranch() const;
+
+    /// Does this instruction write to memory?
+    bool IsStore() const;
+
+    /// Can executing this instruction raise an exception (and thus enter
+    /// the kernel)?
+    ///
+    /// Only a few arithmetic instructions are known not to; everything
+    /// else is assumed to possibly trap.
+    bool MayTrap() const;
+
     unsigned value;  //< Binary representation of the instruction.
 
     unsigned char opCode;  ///< Type of instruction.  This is NOT the same as
@@ -33,6 +47,12 @@ public:
     unsigned char rs, rt, rd;  ///< Three registers from instruction.
     int extra;  ///< Immediate or target or shamt field or offset.
                 ///< Immediates are sign-extended.
+
+#ifdef THREADED_CORE
+    /// Where the code that executes this instruction starts, inside
+    /// `Machine::ExecThreaded`.  Filled in by the decode cache.
+    const void *handler;
+#endif
 };
 
 
@@ -59,10 +59,184 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, void *param,
     ASSERT(func != nullptr);
     ASSERT(IsIntType(kind));
 
-    handler = func;
-    arg     = param;
-    when    = time;
-    type    = kind;
+    handler  = func;
+    arg      = param;
+    when     = time;
+    type     = kind;
+    order    = 0;
+    nextFree = nullptr;
+}
+
+PendingQueue::PendingQueue()
+{
+    capacity  = 8;
+    heap      = new PendingInterrupt *[capacity];
+    size      = 0;
+    nextOrder = 0;
+    pool      = nullptr;
+}
+
+PendingQueue::~PendingQueue()
+{
+    for (unsigned i = 0; i < size; i++) {
+        delete heap[i];
+    }
+    delete [] heap;
+    while (pool != nullptr) {
+        PendingInterrupt *next = pool->nextFree;
+        delete pool;
+        pool = next;
+    }
+}
+
+PendingInterrupt *
+PendingQueue::Allocate(VoidFunctionPtr func, void *param,
+                       unsigned long time, IntType kind)
+{
+    if (pool == nullptr) {
+        return new PendingInterrupt(func, param, time, kind);
+    }
+
+    ASSERT(func != nullptr);
+    ASSERT(IsIntType(kind));
+
+    PendingInterrupt *pend = pool;
+    pool = pend->nextFree;
+    pend->handler  = func;
+    pend->arg      = param;
+    pend->when     = time;
+    pend->type     = kind;
+    pend->nextFree = nullptr;
+    return pend;
+}
+
+void
+PendingQueue::Free(PendingInterrupt *pend)
+{
+    ASSERT(pend != nullptr);
+
+    pend->nextFree = pool;
+    pool = pend;
+}
+
+bool
+PendingQueue::Before(const PendingInterrupt *a, const PendingInterrupt *b)
+{
+    return a->when < b->when || (a->when == b->when && a->order < b->order);
+}
+
+void
+PendingQueue::SiftUp(unsigned i)
+{
+    PendingInterrupt *pend = heap[i];
+    while (i > 0) {
+        unsigned parent = (i - 1) / 2;
+        if (!Before(pend, heap[parent])) {
+            break;
+        }
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = pend;
+}
+
+void
+PendingQueue::SiftDown(unsigned i)
+{
+    PendingInterrupt *pend = heap[i];
+    for (;;) {
+        unsigned child = 2 * i + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size && Before(heap[child + 1], heap[child])) {
+            child++;
+        }
+        if (!Before(heap[child], pend)) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = pend;
+}
+
+void
+PendingQueue::Insert(PendingInterrupt *pend)
+{
+    ASSERT(pend != nullptr);
+
+    if (size == capacity) {
+        PendingInterrupt **bigger = new PendingInterrupt *[2 * capacity];
+        for (unsigned i = 0; i < size; i++) {
+            bigger[i] = heap[i];
+        }
+        delete [] heap;
+        heap = bigger;
+        capacity *= 2;
+    }
+    pend->order = nextOrder++;
+    heap[size++] = pend;
+    SiftUp(size - 1);
+}
+
+PendingInterrupt *
+PendingQueue::Pop()
+{
+    if (size == 0) {
+        return nullptr;
+    }
+
+    PendingInterrupt *first = heap[0];
+    heap[0] = heap[--size];
+    if (size > 0) {
+        SiftDown(0);
+    }
+    return first;
+}
+
+PendingInterrupt *
+PendingQueue::Head() const
+{
+    return size == 0 ? nullptr : heap[0];
+}
+
+bool
+PendingQueue::IsEmpty() const
+{
+    return size == 0;
+}
+
+void
+PendingQueue::Shift(unsigned long ticks)
+{
+    for (unsigned i = 0; i < size; i++) {
+        heap[i]->when = (unsigned) (heap[i]->when - ticks);
+    }
+    // Wrapped around times may now be out of place: rebuild the heap.
+    for (unsigned i = size / 2; i > 0; i--) {
+        SiftDown(i - 1);
+    }
+}
+
+void
+PendingQueue::Apply(void (*func)(PendingInterrupt *)) const
+{
+    ASSERT(func != nullptr);
+
+    // The heap is not sorted, so go through a sorted copy of it.
+    PendingInterrupt **sorted = new PendingInterrupt *[size];
+    for (unsigned i = 0; i < size; i++) {
+        unsigned j = i;
+        for (; j > 0 && Before(heap[i], sorted[j - 1]); j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = heap[i];
+    }
+    for (unsigned i = 0; i < size; i++) {
+        func(sorted[i]);
+    }
+    delete [] sorted;
 }
 
 /// Initialize the simulation of hardware device interrupts.
@@ -71,19 +245,27 @@ PendingInterrupt::PendingInterrupt(VoidFunctionPtr func, void *param,
 Interrupt::Interrupt()
 {
     level         = INT_OFF;
-    pending       = new List<PendingInterrupt *>;
+    pending       = new PendingQueue;
     inHandler     = false;
     yieldOnReturn = false;
     status        = SYSTEM_MODE;
+    nextDue       = ULONG_MAX;
+    traceInterrupts = debug.IsEnabled('i');
+    numCPUs       = 1;
+    cpu           = 0;
+    clocks        = nullptr;
+    running       = nullptr;
+    othersLast    = ULONG_MAX;
+    turnEnd       = ULONG_MAX;
+    turnOver      = false;
 }
 
 /// De-allocate the data structures needed by the interrupt simulation.
 Interrupt::~Interrupt()
 {
-    while (!pending->IsEmpty()) {
-        delete pending->Pop();
-    }
     delete pending;
+    delete [] clocks;
+    delete [] running;
 }
 
 /// Change interrupts to be enabled or disabled, without advancing the
@@ -142,6 +324,10 @@ Interrupt::Enable()
 /// Two things can cause `OneTick` to be called:
 /// * interrupts are re-enabled;
 /// * a user instruction is executed.
+///
+/// In both cases interrupts end up enabled.  Most of the time nothing is
+/// due yet, and then there is no point in disabling them and looking at the
+/// pending list: advancing the clock is all there is to do.
 void
 Interrupt::OneTick()
 {
@@ -149,12 +335,25 @@ Interrupt::OneTick()
 
     // Advance simulated time.
     if (status == SYSTEM_MODE) {
-        stats->totalTicks += SYSTEM_TICK;
+        if (clocks == nullptr) {
+            stats->totalTicks += SYSTEM_TICK;
+        } else {
+            AdvanceClock(SYSTEM_TICK);
+        }
         stats->systemTicks += SYSTEM_TICK;
     } else {  // USER_PROGRAM
-        stats->totalTicks += USER_TICK;
+        if (clocks == nullptr) {
+            stats->totalTicks += USER_TICK;
+        } else {
+            AdvanceClock(USER_TICK);
+        }
         stats->userTicks += USER_TICK;
     }
+    if (stats->totalTicks < nextDue && !yieldOnReturn && !traceInterrupts
+          && !turnOver) {
+        level = INT_ON;
+        return;
+    }
     DEBUG('i', "== Tick %u ==\n", stats->totalTicks);
 
     // Check any pending interrupts are now ready to fire.
@@ -170,6 +369,152 @@ Interrupt::OneTick()
         currentThread->Yield();
         status = old;
     }
+    if (turnOver && old == USER_MODE) {
+        // Another CPU may run now.  CPUs only take turns between user
+        // instructions, so that the kernel keeps running on one CPU at a
+        // time, as if it were a uniprocessor.
+        status = SYSTEM_MODE;
+        ChangeLevel(INT_ON, INT_OFF);
+        scheduler->Interleave();
+        ChangeLevel(INT_OFF, INT_ON);
+        status = old;
+    }
+}
+
+/// An interrupt due at time `t` fires in the first `OneTick` that leaves
+/// `totalTicks` at `t` or later, and the turn of a CPU is over in the first
+/// one that leaves its clock at `turnEnd` or later.
+///
+/// With several CPUs, `totalTicks` is the earliest of their clocks, and the
+/// others do not advance while this one runs: if one of them is behind
+/// `nextDue`, no interrupt can become due before the turn is over.
+unsigned long
+Interrupt::TicksLeft() const
+{
+    if (clocks == nullptr) {
+        return nextDue > stats->totalTicks ? nextDue - stats->totalTicks : 0;
+    }
+    unsigned long now = clocks[cpu];
+    unsigned long until = turnEnd;
+    if (othersLast >= nextDue && nextDue < until) {
+        until = nextDue;
+    }
+    return until > now ? until - now : 0;
+}
+
+void
+Interrupt::UpdateNextDue()
+{
+    PendingInterrupt *head = pending->Head();
+    nextDue = head == nullptr ? ULONG_MAX : head->when;
+}
+
+/// Advance simulated time as `count` calls to `OneTick` would, provided
+/// that no interrupt becomes due meanwhile.
+///
+/// It is up to the caller to check that with `TicksLeft`; used by the
+/// simulator to charge the ticks of a whole block of user instructions at
+/// once.
+void
+Interrupt::AdvanceTicks(unsigned count)
+{
+    unsigned long ticks = count * (status == SYSTEM_MODE ? SYSTEM_TICK
+                                                         : USER_TICK);
+    if (clocks == nullptr) {
+        stats->totalTicks += ticks;
+    } else {
+        AdvanceClock(ticks);
+    }
+    if (status == SYSTEM_MODE) {
+        stats->systemTicks += ticks;
+    } else {
+        stats->userTicks += ticks;
+    }
+}
+
+void
+Interrupt::AdvanceClock(unsigned long ticks)
+{
+    unsigned long now = clocks[cpu] += ticks;
+    stats->cpuBusyTicks[cpu] += ticks;
+    stats->totalTicks = now < othersLast ? now : othersLast;
+    if (now >= turnEnd) {
+        turnOver = true;
+    }
+}
+
+void
+Interrupt::SetCPUs(unsigned n)
+{
+    ASSERT(n > 0);
+    ASSERT(clocks == nullptr);
+
+    numCPUs = n;
+    stats->SetCPUs(n);
+    if (n == 1) {
+        return;
+    }
+    clocks = new unsigned long [n];
+    running = new bool [n];
+    for (unsigned i = 0; i < n; i++) {
+        clocks[i] = stats->totalTicks;
+        running[i] = i == 0;
+    }
+    SwitchCPU(0);
+}
+
+/// Recompute `othersLast`.
+static unsigned long
+EarliestOther(const unsigned long *clocks, const bool *running, unsigned n,
+              unsigned cpu)
+{
+    unsigned long earliest = ULONG_MAX;
+    for (unsigned i = 0; i < n; i++) {
+        if (i != cpu && running[i] && clocks[i] < earliest) {
+            earliest = clocks[i];
+        }
+    }
+    return earliest;
+}
+
+void
+Interrupt::StartCPU(unsigned aCpu)
+{
+    ASSERT(clocks != nullptr && aCpu < numCPUs);
+
+    running[aCpu] = true;
+    if (clocks[aCpu] < stats->totalTicks) {
+        clocks[aCpu] = stats->totalTicks;
+    }
+    othersLast = EarliestOther(clocks, running, numCPUs, cpu);
+}
+
+void
+Interrupt::StopCPU(unsigned aCpu)
+{
+    ASSERT(clocks != nullptr && aCpu < numCPUs);
+
+    running[aCpu] = false;
+    othersLast = EarliestOther(clocks, running, numCPUs, cpu);
+}
+
+void
+Interrupt::SwitchCPU(unsigned aCpu)
+{
+    ASSERT(clocks != nullptr && aCpu < numCPUs);
+    ASSERT(running[aCpu]);
+
+    cpu = aCpu;
+    othersLast = EarliestOther(clocks, running, numCPUs, cpu);
+    turnEnd = clocks[cpu] + CPU_TURN_TICKS;
+    turnOver = false;
+}
+
+unsigned long
+Interrupt::GetClock(unsigned aCpu) const
+{
+    ASSERT(aCpu < numCPUs);
+    return clocks == nullptr ? stats->totalTicks : clocks[aCpu];
 }
 
 /// Called from within an interrupt handler, to cause a context switch (for
@@ -223,6 +568,14 @@ void
 Interrupt::Halt()
 {
     printf("Machine halting!\n\n");
+    if (clocks != nullptr) {
+        // The CPUs that ran ahead of the others count, too.
+        for (unsigned i = 0; i < numCPUs; i++) {
+            if (clocks[i] > stats->totalTicks) {
+                stats->totalTicks = clocks[i];
+            }
+        }
+    }
     stats->Print();
     Cleanup();  // Never returns.
 }
@@ -237,28 +590,27 @@ Interrupt::Halt()
 void
 Interrupt::RestartTicks()
 {
-    List<PendingInterrupt *> *oldPending = pending;
-    pending = new List<PendingInterrupt *>;
-
-    PendingInterrupt *i;
-    unsigned          oldWhen = 0;
-    while ((i = oldPending->SortedPop((int *) &oldWhen)) != nullptr) {
-        unsigned newWhen = oldWhen - stats->totalTicks;
-        pending->SortedInsert(i, newWhen);
-        DEBUG('x', "Interrupt at time %u re-scheduled at new time %u.\n",
-              oldWhen, newWhen);
+    DEBUG('x', "Interrupts re-scheduled %lu ticks earlier.\n",
+          stats->totalTicks);
+    pending->Shift(stats->totalTicks);
+    if (clocks != nullptr) {
+        for (unsigned i = 0; i < numCPUs; i++) {
+            clocks[i] = clocks[i] > stats->totalTicks
+                        ? clocks[i] - stats->totalTicks : 0;
+        }
+        turnEnd -= stats->totalTicks;
+        othersLast = EarliestOther(clocks, running, numCPUs, cpu);
     }
-
-    delete oldPending;
     stats->totalTicks = 0;
     stats->tickResets += 1;
+    UpdateNextDue();
 }
 #endif
 
 /// Arrange for the CPU to be interrupted when simulated time reaches `now +
 /// when`.
 ///
-/// Implementation: just put it on a sorted list.
+/// Implementation: just put it on the queue of pending interrupts.
 ///
 /// NOTE: the Nachos kernel should not call this routine directly.  Instead,
 /// it is only called by the hardware device simulators.
@@ -288,13 +640,15 @@ Interrupt::Schedule(VoidFunctionPtr handler, void *arg,
 #endif
 
     unsigned when = stats->totalTicks + fromNow;
-    PendingInterrupt *toOccur = new PendingInterrupt(handler, arg,
-                                                     when, type);
+    PendingInterrupt *toOccur = pending->Allocate(handler, arg, when, type);
 
     DEBUG('i', "Scheduling interrupt handler for the %s at time = %u\n",
           INT_TYPE_NAMES[type], when);
 
-    pending->SortedInsert(toOccur, when);
+    pending->Insert(toOccur);
+    if (when < nextDue) {
+        nextDue = when;
+    }
 }
 
 /// Check if an interrupt is scheduled to occur, and if so, fire it off.
@@ -309,34 +663,40 @@ bool
 Interrupt::CheckIfDue(bool advanceClock)
 {
     MachineStatus old = status;
-    unsigned      when;
 
     ASSERT(level == INT_OFF);  // Interrupts need to be disabled, to invoke
                                // an interrupt handler.
     if (debug.IsEnabled('i')) {
         DumpState();
     }
-    PendingInterrupt *toOccur = pending->SortedPop((int *) &when);
+    PendingInterrupt *toOccur = pending->Pop();
 
     if (toOccur == nullptr) {  // No pending interrupts.
         return false;
     }
 
+    unsigned long when = toOccur->when;
+
     if (advanceClock && when > stats->totalTicks) {  // Advance the clock.
         stats->idleTicks += (when - stats->totalTicks);
         stats->totalTicks = when;
+        if (clocks != nullptr) {
+            clocks[cpu] = when;  // The only CPU left, waiting.
+        }
     } else if (when > stats->totalTicks) {  // Not time yet, put it back.
-        pending->SortedInsert(toOccur, when);
+        pending->Insert(toOccur);
         return false;
     }
 
     // Check if there is nothing more to do, and if so, quit.
     if (status == IDLE_MODE && toOccur->type == TIMER_INT
           && pending->IsEmpty()) {
-        pending->SortedInsert(toOccur, when);
+        pending->Insert(toOccur);
         return false;
     }
 
+    UpdateNextDue();  // `Schedule` keeps it up to date from now on.
+
     DEBUG('i', "Invoking interrupt handler for the %s at time %u\n",
             INT_TYPE_NAMES[toOccur->type], toOccur->when);
 #ifdef USER_PROGRAM
@@ -350,7 +710,7 @@ Interrupt::CheckIfDue(bool advanceClock)
     (*toOccur->handler)(toOccur->arg);  // Call the interrupt handler.
     status = old;  // Restore the machine status.
     inHandler = false;
-    delete toOccur;
+    pending->Free(toOccur);
     return true;
 }
 
@@ -56,6 +56,10 @@ enum MachineStatus {
     NUM_MACHINE_STATUS
 };
 
+/// Ticks a CPU runs, when there are several, before letting another one
+/// have its turn.
+const unsigned long CPU_TURN_TICKS = 100;
+
 /// `IntType` records which hardware device generated an interrupt.  In
 /// Nachos, we support a hardware timer device, a disk and a console display and
 /// keyboard.
@@ -85,6 +89,73 @@ public:
     void *arg;  ///< The argument to the function.
     unsigned long when;  ///< When the interrupt is supposed to fire.
     IntType type;  ///< For debugging.
+    unsigned long order;  ///< Breaks ties between interrupts due at the
+                          ///< same time: the one scheduled first fires
+                          ///< first.
+    PendingInterrupt *nextFree;  ///< Link in the pool of unused nodes.
+};
+
+/// The following class defines a queue of pending interrupts, ordered by
+/// the time they are due.
+///
+/// It is a binary min-heap, so both adding an interrupt and taking the
+/// earliest one out take O(log n) steps, instead of the linear insertion
+/// of a sorted `List`.  Interrupts due at the same time come out in the
+/// order they went in, just as with `List::SortedInsert`.
+///
+/// Devices reschedule themselves all the time, so the nodes are not given
+/// back to the heap allocator: `Free` keeps them in a pool, from which
+/// `Allocate` takes them again.
+class PendingQueue {
+public:
+
+    /// Initialize an empty queue, with an empty pool.
+    PendingQueue();
+
+    /// De-allocate the queue, the interrupts still in it, and the pool.
+    ~PendingQueue();
+
+    /// Get a node from the pool (or a new one if the pool is empty) and
+    /// initialize it, as the constructor of `PendingInterrupt` would.
+    PendingInterrupt *Allocate(VoidFunctionPtr func, void *param,
+                               unsigned long time, IntType kind);
+
+    /// Give a node that is not in the queue back to the pool.
+    void Free(PendingInterrupt *pend);
+
+    /// Add `pend` to the queue, after any other due at the same time.
+    void Insert(PendingInterrupt *pend);
+
+    /// Take the earliest interrupt out of the queue; null if it is empty.
+    PendingInterrupt *Pop();
+
+    /// Return the earliest interrupt without taking it out; null if the
+    /// queue is empty.
+    PendingInterrupt *Head() const;
+
+    bool IsEmpty() const;
+
+    /// Subtract `ticks` from the time of every interrupt, wrapping around
+    /// as unsigned 32-bit numbers do.
+    void Shift(unsigned long ticks);
+
+    /// Apply `func` to every interrupt, in the order they are due.
+    void Apply(void (*func)(PendingInterrupt *)) const;
+
+private:
+
+    /// Does `a` fire before `b`?
+    static bool Before(const PendingInterrupt *a, const PendingInterrupt *b);
+
+    /// Restore the heap property around position `i`.
+    void SiftUp(unsigned i);
+    void SiftDown(unsigned i);
+
+    PendingInterrupt **heap;  ///< The heap, with the earliest at index 0.
+    unsigned size;            ///< Number of interrupts in `heap`.
+    unsigned capacity;        ///< Number of slots in `heap`.
+    unsigned long nextOrder;  ///< `order` for the next inserted interrupt.
+    PendingInterrupt *pool;   ///< Unused nodes, linked by `nextFree`.
 };
 
 /// The following class defines the data structures for the simulation
@@ -128,6 +199,28 @@ public:
     // Print interrupt state.
     void DumpState();
 
+    /// Simulate `n` CPUs, each with a clock of its own.
+    ///
+    /// Only one CPU runs at a time, and only its clock advances; the
+    /// others are frozen until they get their turn.  Simulated time, as
+    /// seen by devices and kept in `stats->totalTicks`, is the clock of the
+    /// CPU furthest behind among those with a thread to run, so that work
+    /// done in parallel by several CPUs takes no longer than the longest
+    /// share of it.  At first, only CPU 0 runs.
+    void SetCPUs(unsigned n);
+
+    /// CPU `cpu` got a thread to run: from now on it counts as running,
+    /// and its clock catches up with the simulated time if it was behind.
+    void StartCPU(unsigned cpu);
+
+    /// CPU `cpu` has nothing to run.
+    void StopCPU(unsigned cpu);
+
+    /// Let CPU `cpu`, which must be running, have its turn.
+    void SwitchCPU(unsigned cpu);
+
+    unsigned long GetClock(unsigned cpu) const;
+
 
     /// NOTE: the following are internal to the hardware simulation code.
     /// DO NOT call these directly.  I should make them “private”,
@@ -143,20 +236,55 @@ public:
     /// Advance simulated time.
     void OneTick();
 
+    /// Return how many ticks the clock of the running CPU can advance
+    /// before `OneTick` has more to do than advancing it: before the
+    /// earliest pending interrupt is due or the turn of the CPU is over.
+    unsigned long TicksLeft() const;
+
+    /// Advance simulated time by `count` ticks without checking for
+    /// pending interrupts.
+    void AdvanceTicks(unsigned count);
+
 private:
     IntStatus level;  ///< Are interrupts enabled or disabled?
-    List<PendingInterrupt *> *pending;  ///< The list of interrupts scheduled
-                                        ///< to occur in the future.
+    PendingQueue *pending;  ///< The interrupts scheduled to occur in the
+                            ///< future.
     bool inHandler;  ///< True if we are running an interrupt handler.
     bool yieldOnReturn;  ///< True if we are to context switch on return from
                          ///< the interrupt handler.
     MachineStatus status;  ///< Idle, kernel mode, user mode.
 
+    /// When the earliest pending interrupt is due (the key of the head of
+    /// `pending`), or `ULONG_MAX` if there is none.  Until then, `OneTick`
+    /// only needs to advance the clock.
+    unsigned long nextDue;
+
+    /// Whether interrupt debugging messages are enabled; if so, `OneTick`
+    /// always takes the full path, so that every tick is traced.
+    bool traceInterrupts;
+
+    /// Multiprocessor state (see `SetCPUs`); `clocks` is null if there is
+    /// a single CPU.
+    unsigned numCPUs;
+    unsigned cpu;              ///< CPU whose clock is advancing.
+    unsigned long *clocks;     ///< Time of each CPU.
+    bool *running;             ///< Whether each CPU has a thread.
+    unsigned long othersLast;  ///< Earliest clock among the other running
+                               ///< CPUs, or `ULONG_MAX`.
+    unsigned long turnEnd;     ///< When the turn of `cpu` is over.
+    bool turnOver;             ///< Whether it is over.
+
+    /// Advance the clock of the running CPU by `ticks`.
+    void AdvanceClock(unsigned long ticks);
+
     /// These functions are internal to the interrupt simulation code.
 
     /// Check if an interrupt is supposed to occur now.
     bool CheckIfDue(bool advanceClock);
 
+    /// Set `nextDue` from the head of `pending`.
+    void UpdateNextDue();
+
     /// SetLevel, without advancing the simulated time.
     void ChangeLevel(IntStatus old,
                      IntStatus now);
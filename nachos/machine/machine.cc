@@ -9,6 +9,7 @@
 
 
 #include "machine.hh"
+#include "decode_cache.hh"
 #include "threads/system.hh"
 
 
@@ -43,6 +44,11 @@ CheckEndian()
 Machine::~Machine()
 {
     delete [] mainMemory;
+    for (unsigned i = numCPUs; i > 0; i--) {
+        delete mmus[i - 1];  // The first one owns the decode cache.
+    }
+    delete [] mmus;
+    delete [] cpuRegisters;
 }
 
 /// Initialize the simulation of user program execution.
@@ -50,10 +56,34 @@ Machine::~Machine()
 /// * `st` -- pointer to an object that performs single stepping, for
 ///   dropping into it after each user instruction is executed; if null,
 ///   execute normally, without single stepping.
-Machine::Machine(SingleStepper *st, unsigned aNumPhysicalPages): mmu(aNumPhysicalPages)
+/// * `useBlocks` -- run user programs a basic block at a time (see
+///   `RunBlock`).  Ignored if instructions, translations or interrupts are
+///   being traced, since those traces are per instruction.
+/// * `tlbSize`, `tlbWays` -- shape of the TLB, if there is one (see
+///   `MMU::MMU`).
+/// * `numCPUs` -- number of CPUs; each gets its own registers and MMU
+///   (with a TLB of `tlbSize` entries).
+Machine::Machine(SingleStepper *st, unsigned aNumPhysicalPages,
+                 bool useBlocks, unsigned tlbSize, unsigned tlbWays,
+                 unsigned aNumCPUs)
 {
+    ASSERT(aNumCPUs > 0);
+
+    numCPUs = aNumCPUs;
+    cpu = 0;
+    mmus = new MMU *[numCPUs];
+    mmus[0] = new MMU(aNumPhysicalPages, tlbSize, tlbWays);
+    for (unsigned i = 1; i < numCPUs; i++) {
+        mmus[i] = new MMU(aNumPhysicalPages, tlbSize, tlbWays,
+                          mmus[0]->GetDecodeCache());
+    }
+    mmu = mmus[0];
+    cpuRegisters = new int [numCPUs][NUM_TOTAL_REGS];
     for (unsigned i = 0; i < NUM_TOTAL_REGS; i++) {
         registers[i] = 0;
+        for (unsigned j = 0; j < numCPUs; j++) {
+            cpuRegisters[j][i] = 0;
+        }
     }
 
     for (unsigned i = 0; i < NUM_EXCEPTION_TYPES; i++) {
@@ -61,7 +91,12 @@ Machine::Machine(SingleStepper *st, unsigned aNumPhysicalPages): mmu(aNumPhysica
     }
 
     singleStepper = st;
+    runBlocks = useBlocks && !debug.IsEnabled('m') && !debug.IsEnabled('a')
+                && !debug.IsEnabled('i');
     CheckEndian();
+#ifdef THREADED_CORE
+    ExecThreaded(nullptr, 0, nullptr);  // Fill in the handler table.
+#endif
 
     unsigned memory_size = aNumPhysicalPages * PAGE_SIZE;
     mainMemory = new char [memory_size];
@@ -84,7 +119,42 @@ Machine::GetRegisters() const
 MMU *
 Machine::GetMMU()
 {
-    return &mmu;
+    return mmu;
+}
+
+MMU *
+Machine::GetMMU(unsigned aCpu)
+{
+    ASSERT(aCpu < numCPUs);
+    return mmus[aCpu];
+}
+
+unsigned
+Machine::GetNumCPUs() const
+{
+    return numCPUs;
+}
+
+unsigned
+Machine::GetCPU() const
+{
+    return cpu;
+}
+
+void
+Machine::SetCPU(unsigned aCpu)
+{
+    ASSERT(aCpu < numCPUs);
+
+    if (aCpu == cpu) {
+        return;
+    }
+    for (unsigned i = 0; i < NUM_TOTAL_REGS; i++) {
+        cpuRegisters[cpu][i] = registers[i];
+        registers[i] = cpuRegisters[aCpu][i];
+    }
+    cpu = aCpu;
+    mmu = mmus[cpu];
 }
 
 /// Fetch or write the contents of a user program register.
@@ -110,7 +180,7 @@ Machine::WriteRegister(unsigned num, int value)
 bool
 Machine::ReadMem(unsigned addr, unsigned size, int *value)
 {
-    ExceptionType e = mmu.ReadMem(addr, size, value);
+    ExceptionType e = mmu->ReadMem(addr, size, value);
     if (e != NO_EXCEPTION) {
         RaiseException(e, addr);
         return false;
@@ -121,7 +191,7 @@ Machine::ReadMem(unsigned addr, unsigned size, int *value)
 bool
 Machine::WriteMem(unsigned addr, unsigned size, int value)
 {
-    ExceptionType e = mmu.WriteMem(addr, size, value);
+    ExceptionType e = mmu->WriteMem(addr, size, value);
     if (e != NO_EXCEPTION) {
         RaiseException(e, addr);
         return false;
@@ -68,7 +68,9 @@ class Machine {
 public:
 
     /// Initialize the simulation of the hardware for running user programs.
-    Machine(SingleStepper *st, unsigned numPhysicalPages);
+    Machine(SingleStepper *st, unsigned numPhysicalPages,
+            bool useBlocks = false, unsigned tlbSize = DEFAULT_TLB_SIZE,
+            unsigned tlbWays = 0, unsigned numCPUs = 1);
 
     ~Machine();
     /// Routines callable by the Nachos kernel.
@@ -78,7 +80,22 @@ public:
 
     const int *GetRegisters() const;
 
+    /// Return the MMU of the running CPU, or that of CPU `cpu`.
     MMU *GetMMU();
+    MMU *GetMMU(unsigned cpu);
+
+    /// The machine may have several CPUs, sharing the main memory; each
+    /// has its own registers and MMU.  Only one of them runs at a time:
+    /// the kernel lets them take turns (see `Scheduler::Interleave`).
+    unsigned GetNumCPUs() const;
+
+    /// Return the CPU that is running.
+    unsigned GetCPU() const;
+
+    /// Let CPU `cpu` run: from now on, registers and memory accesses are
+    /// those of `cpu`.  The registers of the CPU that was running are kept
+    /// until it runs again.
+    void SetCPU(unsigned cpu);
 
     /// Read the contents of a CPU register.
     int ReadRegister(unsigned num) const;
@@ -100,11 +117,27 @@ public:
 
     /// Fetch one instruction of a user program.
     ///
-    /// Return false if an exception occurs, true otherwise.
-    bool FetchInstruction(Instruction *instr);
+    /// Return null if an exception occurs, the decoded instruction
+    /// otherwise.  The instruction belongs to the MMU's decode cache and
+    /// must not be used after trapping into the kernel.
+    const Instruction *FetchInstruction();
 
     /// Run a certain instruction of a user program.
-    void ExecInstruction(const Instruction *instr);
+    ///
+    /// Return false if an exception occurs, true otherwise.
+    bool ExecInstruction(const Instruction *instr);
+
+    /// Run a whole basic block of a user program.
+    void RunBlock();
+
+#ifdef THREADED_CORE
+    /// Run part of a basic block with direct threaded dispatch.
+    unsigned ExecThreaded(const Instruction *block, unsigned length,
+                          unsigned *settled);
+
+    /// Return where the handler for `opCode` starts, in `ExecThreaded`.
+    static const void *ThreadedHandler(unsigned opCode);
+#endif
 
     /// Do a pending delayed load (modifying a reg).
     void DelayedLoad(unsigned nextReg, int nextVal);
@@ -135,7 +168,18 @@ private:
     int registers[NUM_TOTAL_REGS];  ///< CPU registers, for executing user
                                     ///< programs.
 
-    MMU mmu; ///< Memory management unit.
+    MMU *mmu; ///< Memory management unit of the running CPU.
+
+    unsigned numCPUs;
+    unsigned cpu;  ///< The running CPU.
+    MMU **mmus;    ///< The MMU of each CPU.
+
+    /// Registers of each CPU while it is not running (those of the running
+    /// one are in `registers`).
+    int (*cpuRegisters)[NUM_TOTAL_REGS];
+
+    bool runBlocks;  ///< Run a basic block per dispatch, rather than a
+                     ///< single instruction.
 
     ExceptionHandler handlers[NUM_EXCEPTION_TYPES];  ///< Exception handlers.
     unsigned numPhysicalPages;
@@ -29,6 +29,7 @@
 
 
 #include "mmu.hh"
+#include "decode_cache.hh"
 #include "machine.hh"
 #include "endianness.hh"
 #include "threads/system.hh"
@@ -37,13 +38,26 @@
 extern Machine* machine;
 
 
-MMU::MMU(unsigned aNumPhysPages)
+MMU::MMU(unsigned aNumPhysPages, unsigned aTlbSize, unsigned aTlbWays,
+         DecodeCache *sharedDecodeCache)
 {
+    ASSERT(aTlbSize > 0);
+    ASSERT(aTlbWays <= aTlbSize);
+
     numPhysicalPages = aNumPhysPages;
     memorySize = numPhysicalPages * PAGE_SIZE;
+    tlbSize = aTlbSize;
+    tlbWays = aTlbWays == 0 ? aTlbSize : aTlbWays;
+    ASSERT(tlbSize % tlbWays == 0);
+    ASSERT(tlbWays >= 2);
+      // An instruction may need two translations at once (its own and
+      // that of the data it accesses); with a single way they could keep
+      // evicting each other forever.
+    tlbSets = tlbSize / tlbWays;
+    asid = 0;
 #ifdef USE_TLB
-    tlb = new TranslationEntry[TLB_SIZE];
-    for (unsigned i = 0; i < TLB_SIZE; i++) {
+    tlb = new TranslationEntry[tlbSize];
+    for (unsigned i = 0; i < tlbSize; i++) {
         tlb[i].valid = false;
     }
     pageTable = nullptr;
@@ -51,7 +65,14 @@ MMU::MMU(unsigned aNumPhysPages)
     tlb = nullptr;
     pageTable = nullptr;
 #endif
-
+    ownsDecodeCache = sharedDecodeCache == nullptr;
+    decodeCache = ownsDecodeCache ? new DecodeCache(numPhysicalPages)
+                                  : sharedDecodeCache;
+    fetchEntry = nullptr;
+    for (unsigned i = 0; i < HOST_CACHE_SIZE; i++) {
+        hostCache[i].entry = nullptr;
+    }
+    traceTranslation = debug.IsEnabled('a');
 }
 
 MMU::~MMU()
@@ -59,17 +80,22 @@ MMU::~MMU()
     if (tlb != nullptr) {
         delete [] tlb;
     }
+    if (ownsDecodeCache) {
+        delete decodeCache;
+    }
 }
 
 void
 MMU::PrintTLB() const
 {
 #ifdef USE_TLB
-    printf("TLB content (%u entries):\n", TLB_SIZE);
-    for (unsigned i = 0; i < TLB_SIZE; i++) {
+    printf("TLB content (%u entries, %u per set, current ASID %u):\n",
+           tlbSize, tlbWays, asid);
+    for (unsigned i = 0; i < tlbSize; i++) {
         const TranslationEntry *e = &tlb[i];
-        printf("(%u) valid: %d, virt: %d, frame: %d, flags: %s%s%s\n",
-               i, e->valid, e->virtualPage, e->physicalPage,
+        printf("(%u) valid: %d, asid: %u, virt: %d, frame: %d,"
+               " flags: %s%s%s\n",
+               i, e->valid, e->asid, e->virtualPage, e->physicalPage,
                (e->readOnly) ? "readonly " : "",
                (e->use)      ? "use " : "",
                (e->dirty)    ? "dirty" : "");
@@ -79,6 +105,49 @@ MMU::PrintTLB() const
 #endif
 }
 
+unsigned
+MMU::GetTLBSize() const
+{
+    return tlbSize;
+}
+
+unsigned
+MMU::GetTLBWays() const
+{
+    return tlbWays;
+}
+
+unsigned
+MMU::TLBSet(unsigned vpn) const
+{
+    return vpn % tlbSets * tlbWays;
+}
+
+void
+MMU::SetASID(unsigned newAsid)
+{
+    asid = newAsid;
+}
+
+unsigned
+MMU::GetASID() const
+{
+    return asid;
+}
+
+void
+MMU::FlushTLB(unsigned which)
+{
+    ASSERT(tlb != nullptr);
+
+    for (unsigned i = 0; i < tlbSize; i++) {
+        if (tlb[i].asid == which) {
+            tlb[i].valid = false;
+        }
+    }
+    stats->tlbFlushes++;
+}
+
 /// Read `size` (1, 2, or 4) bytes of virtual memory at `addr` into
 /// the location pointed to by `value`.
 ///
@@ -93,28 +162,29 @@ MMU::ReadMem(unsigned addr, unsigned size, int *value)
 {
     ASSERT(value != nullptr);
 
-    DEBUG('a', "Reading VA 0x%X, size %u\n", addr, size);
-
-    unsigned physicalAddress;
-    ExceptionType e = Translate(addr, &physicalAddress, size, false);
-    if (e != NO_EXCEPTION) {
-        return e;
+    char *host = HostAddress(addr, size, false);
+    if (host == nullptr) {
+        DEBUG('a', "Reading VA 0x%X, size %u\n", addr, size);
+        ExceptionType e = HostTranslate(addr, size, false, &host);
+        if (e != NO_EXCEPTION) {
+            return e;
+        }
     }
 
     int data;
     switch (size) {
         case 1:
-            data = machine->mainMemory[physicalAddress];
+            data = *host;
             *value = data;
             break;
 
         case 2:
-            data = *(unsigned short *) &(machine->mainMemory[physicalAddress]);
+            data = *(unsigned short *) host;
             *value = ShortToHost(data);
             break;
 
         case 4:
-            data = *(unsigned *) &(machine->mainMemory[physicalAddress]);
+            data = *(unsigned *) host;
             *value = WordToHost(data);
             break;
 
@@ -122,7 +192,9 @@ MMU::ReadMem(unsigned addr, unsigned size, int *value)
             ASSERT(false);
     }
 
-    DEBUG('a', "\tValue read: %8.8X\n", *value);
+    if (traceTranslation) {
+        DEBUG('a', "\tValue read: %8.8X\n", *value);
+    }
     return NO_EXCEPTION;
 }
 
@@ -138,37 +210,218 @@ MMU::ReadMem(unsigned addr, unsigned size, int *value)
 ExceptionType
 MMU::WriteMem(unsigned addr, unsigned size, int value)
 {
-    DEBUG('a', "Writing VA 0x%X, size %u, value 0x%X\n", addr, size, value);
-
-    unsigned physicalAddress;
-    ExceptionType e = Translate(addr, &physicalAddress, size, true);
-    if (e != NO_EXCEPTION) {
-        return e;
+    char *host = HostAddress(addr, size, true);
+    if (host == nullptr) {
+        DEBUG('a', "Writing VA 0x%X, size %u, value 0x%X\n",
+              addr, size, value);
+        ExceptionType e = HostTranslate(addr, size, true, &host);
+        if (e != NO_EXCEPTION) {
+            return e;
+        }
     }
 
     switch (size) {
         case 1:
-            machine->mainMemory[physicalAddress]
-              = (unsigned char) (value & 0xFF);
+            *host = (unsigned char) (value & 0xFF);
             break;
 
         case 2:
-            *(unsigned short *) &(machine->mainMemory[physicalAddress])
+            *(unsigned short *) host
               = ShortToMachine((unsigned short) (value & 0xFFFF));
             break;
 
         case 4:
-            *(unsigned *) &(machine->mainMemory[physicalAddress])
-              = WordToMachine((unsigned) value);
+            *(unsigned *) host = WordToMachine((unsigned) value);
             break;
 
         default:
             ASSERT(false);
     }
 
+    decodeCache->InvalidateFrame((host - machine->mainMemory) / PAGE_SIZE);
     return NO_EXCEPTION;
 }
 
+/// Look up the host pointer cache for the `size` bytes at `addr`.
+///
+/// On a hit, the access has the same effects a successful `Translate`
+/// would have (statistics, `use` and `dirty` bits), and the address of the
+/// data in `mainMemory` is returned.
+///
+/// The cache is never told about changes to the TLB, the page tables or
+/// the coremap.  Instead, just like `TranslateFetch` does, a slot is only
+/// used if the entry it was filled from still maps the same page to the
+/// same frame, and allows the access.  So a TLB reload, a page table
+/// switch or a page being evicted invalidate the slot by themselves.
+///
+/// Misaligned accesses always miss, so that `Translate` reports them; and
+/// so does everything while translations are being traced.
+char *
+MMU::HostAddress(unsigned addr, unsigned size, bool writing)
+{
+    unsigned vpn = addr / PAGE_SIZE;
+    HostCacheSlot *slot = &hostCache[vpn % HOST_CACHE_SIZE];
+    TranslationEntry *entry = slot->entry;
+
+    // With a page table, the entry must belong to the current table before
+    // looking into it: the table it came from may be gone already.
+    if (traceTranslation || (addr & (size - 1)) != 0 || entry == nullptr
+          || slot->vpn != vpn
+          || (tlb != nullptr
+              ? entry->asid != asid
+              : vpn >= pageTableSize || entry != &pageTable[vpn])
+          || !entry->valid || entry->virtualPage != vpn
+          || entry->physicalPage != slot->frame
+          || (writing && entry->readOnly)) {
+        return nullptr;
+    }
+
+    if (tlb != nullptr) {
+        stats->memoryAccess++;
+    }
+    entry->use = true;
+    if (writing) {
+        entry->dirty = true;
+    }
+    return slot->page + addr % PAGE_SIZE;
+}
+
+/// Translate the `size` bytes at `addr` with `Translate`, and if that
+/// succeeds, store where they are in `mainMemory` into `*host` and fill
+/// the slot of the host pointer cache for their page.
+ExceptionType
+MMU::HostTranslate(unsigned addr, unsigned size, bool writing, char **host)
+{
+    ASSERT(host != nullptr);
+
+    unsigned physicalAddress;
+    TranslationEntry *entry;
+    ExceptionType e = Translate(addr, &physicalAddress, size, writing,
+                                &entry);
+    if (e != NO_EXCEPTION) {
+        return e;
+    }
+
+    unsigned vpn = addr / PAGE_SIZE;
+    HostCacheSlot *slot = &hostCache[vpn % HOST_CACHE_SIZE];
+    slot->vpn   = vpn;
+    slot->frame = entry->physicalPage;
+    slot->page  = &machine->mainMemory[slot->frame * PAGE_SIZE];
+    slot->entry = entry;
+
+    *host = &machine->mainMemory[physicalAddress];
+    return NO_EXCEPTION;
+}
+
+/// Fetch the instruction at `addr` and return its decoded form in `*instr`.
+///
+/// * `addr` is the virtual address of the instruction.
+/// * `instr` is the place to store a pointer to the decoded instruction.
+ExceptionType
+MMU::FetchInstruction(unsigned addr, const Instruction **instr)
+{
+    ASSERT(instr != nullptr);
+
+    unsigned physicalAddress;
+    ExceptionType e = TranslateFetch(addr, &physicalAddress);
+    if (e != NO_EXCEPTION) {
+        return e;
+    }
+
+    *instr = decodeCache->Lookup(physicalAddress, machine->mainMemory);
+    if (traceTranslation) {
+        DEBUG('a', "\tValue read: %8.8X\n", (*instr)->value);
+    }
+    return NO_EXCEPTION;
+}
+
+/// Fetch the basic block that starts at `addr`.
+///
+/// Only the first instruction of the block is really fetched, with the
+/// same effects as `FetchInstruction`; the caller must use `AccountFetches`
+/// for the other ones it executes.
+///
+/// * `addr` is the virtual address of the first instruction.
+/// * `block` is the place to store the block.
+ExceptionType
+MMU::FetchBlock(unsigned addr, Block *block)
+{
+    ASSERT(block != nullptr);
+
+    unsigned physicalAddress;
+    ExceptionType e = TranslateFetch(addr, &physicalAddress);
+    if (e != NO_EXCEPTION) {
+        return e;
+    }
+
+    decodeCache->LookupBlock(physicalAddress, machine->mainMemory, block);
+    return NO_EXCEPTION;
+}
+
+/// Account for `count` instruction fetches that were not done one by one,
+/// because they belong to the block returned by the last `FetchBlock`.
+///
+/// They would all have hit in the same entry that the first fetch of the
+/// block found, so the only thing left to do is to count them.
+void
+MMU::AccountFetches(unsigned count)
+{
+    if (tlb != nullptr) {
+        stats->memoryAccess += count;
+    }
+}
+
+/// Translate the address of an instruction fetch.
+///
+/// The translation has the same effects as the one done by `ReadMem`
+/// (statistics, `use` bit, exceptions), but while the program counter stays
+/// inside the page of the previous fetch, the entry found then is reused
+/// instead of looking up the TLB again.  The entry is only reused if it is
+/// still valid and still maps the same virtual page, so TLB reloads and page
+/// table switches are noticed without being told about them.
+///
+/// * `addr` is the virtual address to translate.
+/// * `physAddr` is the place to store the physical address.
+ExceptionType
+MMU::TranslateFetch(unsigned addr, unsigned *physAddr)
+{
+    ASSERT(physAddr != nullptr);
+
+    unsigned vpn = addr / PAGE_SIZE;
+    TranslationEntry *entry = fetchEntry;
+
+    // With a page table, the entry must belong to the current table before
+    // looking into it: the table it came from may be gone already.
+    if (!traceTranslation && (addr & 0x3) == 0 && entry != nullptr
+          && (tlb != nullptr
+              ? entry->asid == asid
+              : vpn < pageTableSize && entry == &pageTable[vpn])
+          && entry->valid && entry->virtualPage == vpn
+          && entry->physicalPage < numPhysicalPages) {
+        if (tlb != nullptr) {
+            stats->memoryAccess++;
+        }
+        entry->use = true;
+        *physAddr = entry->physicalPage * PAGE_SIZE + addr % PAGE_SIZE;
+        return NO_EXCEPTION;
+    }
+
+    DEBUG('a', "Reading VA 0x%X, size %u\n", addr, 4);
+    return Translate(addr, physAddr, 4, false, &fetchEntry);
+}
+
+void
+MMU::InvalidateFrame(unsigned frame)
+{
+    decodeCache->InvalidateFrame(frame);
+}
+
+DecodeCache *
+MMU::GetDecodeCache() const
+{
+    return decodeCache;
+}
+
 ExceptionType
 MMU::RetrievePageEntry(unsigned vpn, TranslationEntry **entry) const
 {
@@ -194,11 +447,11 @@ MMU::RetrievePageEntry(unsigned vpn, TranslationEntry **entry) const
 
     } else {
         // Use the TLB.
-        unsigned i;
-        //std::cout << vpn << " ";
-        for (i = 0; i < TLB_SIZE; i++) {
+        // Only the set of `vpn` is searched.
+        unsigned first = TLBSet(vpn);
+        for (unsigned i = first; i < first + tlbWays; i++) {
             TranslationEntry *e = &tlb[i];
-            if (e->valid && e->virtualPage == vpn) {
+            if (e->valid && e->virtualPage == vpn && e->asid == asid) {
                 *entry = e;  // FOUND!
                 stats->memoryAccess++;
                 return NO_EXCEPTION;
@@ -225,9 +478,11 @@ MMU::RetrievePageEntry(unsigned vpn, TranslationEntry **entry) const
 /// * `physAddr" is the place to store the physical address.
 /// * `size" is the amount of memory being read or written.
 /// * `writing` -- if true, check the “read-only” bit in the TLB.
+/// * `usedEntry`, if not null, is where to store the translation entry that
+///   was used, if there was no error.
 ExceptionType
 MMU::Translate(unsigned virtAddr, unsigned *physAddr,
-               unsigned size, bool writing)
+               unsigned size, bool writing, TranslationEntry **usedEntry)
 {
     ASSERT(physAddr != nullptr);
     // We must have either a TLB or a page table, but not both!
@@ -274,6 +529,10 @@ MMU::Translate(unsigned virtAddr, unsigned *physAddr,
         entry->dirty = true;
     }
 
+    if (usedEntry != nullptr) {
+        *usedEntry = entry;
+    }
+
     *physAddr = pageFrame * PAGE_SIZE + offset;
     ASSERT(*physAddr >= 0 && *physAddr + size <= memorySize);
     DEBUG_CONT('a', "physical address 0x%X\n", *physAddr);
@@ -14,6 +14,10 @@
 #include "translation_entry.hh"
 
 
+struct Block;
+class DecodeCache;
+class Instruction;
+
 /// Definitions related to the size, and format of user memory.
 
 const unsigned PAGE_SIZE = SECTOR_SIZE;  ///< Set the page size equal to the
@@ -22,18 +26,41 @@ const unsigned PAGE_SIZE = SECTOR_SIZE;  ///< Set the page size equal to the
 const unsigned DEFAULT_NUM_PHYS_PAGES = 32;
 //const unsigned MEMORY_SIZE = NUM_PHYS_PAGES * PAGE_SIZE;
 
-/// Number of entries in the TLB, if one is present.
+/// Number of entries in the TLB, if one is present and no other size is
+/// asked for (see `-tlb`).
 ///
 /// If there is a TLB, it will be small compared to page tables.
-const unsigned TLB_SIZE = 4;
+const unsigned DEFAULT_TLB_SIZE = 4;
+
 
+/// Number of slots in the host pointer cache of the MMU.  Must be a power
+/// of two.
+const unsigned HOST_CACHE_SIZE = 16;
+
+/// A slot of the host pointer cache: where virtual page `vpn` lives in
+/// `mainMemory`, according to translation entry `entry`.
+struct HostCacheSlot {
+    unsigned vpn;
+    unsigned frame;
+    char *page;
+    TranslationEntry *entry;
+};
 
 /// This class simulates an MMU (memory management unit) that can use either
 /// page tables or a TLB.
 class MMU {
 public:
     // Initialize the MMU subsystem.
-    MMU(unsigned numPhysicalPages);
+    //
+    // If there is a TLB, it has `tlbSize` entries, split in sets of
+    // `tlbWays` entries; 0 ways means a single set (fully associative).
+    // Sets must have at least 2 entries.
+    //
+    // The MMUs of the CPUs of a multiprocessor all see the same physical
+    // memory, so they can share `decodeCache`; if it is null, the MMU
+    // makes its own.
+    MMU(unsigned numPhysicalPages, unsigned tlbSize = DEFAULT_TLB_SIZE,
+        unsigned tlbWays = 0, DecodeCache *decodeCache = nullptr);
 
     // Deallocate data structures.
     ~MMU();
@@ -45,8 +72,50 @@ public:
 
     ExceptionType WriteMem(unsigned addr, unsigned size, int value);
 
+    /// Fetch the instruction at `addr`, already decoded.
+    ///
+    /// Equivalent to reading 4 bytes at `addr` and decoding them, but the
+    /// last translation used for fetching and every decoded instruction are
+    /// remembered, so running code that was already seen does not pay for
+    /// the TLB lookup nor for the decoding again.
+    ExceptionType FetchInstruction(unsigned addr, const Instruction **instr);
+
+    /// Fetch the whole basic block that starts at `addr`, already decoded.
+    ExceptionType FetchBlock(unsigned addr, Block *block);
+
+    /// Account for instructions of a block executed without being fetched.
+    void AccountFetches(unsigned count);
+
+    /// Tell the MMU that the contents of physical page `frame` have been
+    /// changed behind its back, by writing into `mainMemory` directly.
+    ///
+    /// Instructions decoded from that page are discarded.
+    void InvalidateFrame(unsigned frame);
+
     void PrintTLB() const;
 
+    /// Number of entries of the TLB.
+    unsigned GetTLBSize() const;
+
+    /// Number of entries in each set of the TLB.
+    unsigned GetTLBWays() const;
+
+    /// Return the index of the first entry of the TLB set where virtual
+    /// page `vpn` must be loaded; the set spans `GetTLBWays()` entries.
+    unsigned TLBSet(unsigned vpn) const;
+
+    /// Make `asid` the current address space: from now on, only TLB
+    /// entries tagged with it are used.  Entries of other address spaces
+    /// stay in the TLB, so switching back to them finds them there.
+    void SetASID(unsigned asid);
+
+    unsigned GetASID() const;
+
+    /// Invalidate every TLB entry of address space `asid`.
+    void FlushTLB(unsigned asid);
+
+    DecodeCache *GetDecodeCache() const;
+
     /// Data structures -- all of these are accessible to Nachos kernel code.
     /// “Public” for convenience.
     ///
@@ -91,9 +160,46 @@ private:
     /// and return an exception code if the translation could not be
     /// completed.
     ExceptionType Translate(unsigned virtAddr, unsigned *physAddr,
-                            unsigned size, bool writing);
+                            unsigned size, bool writing,
+                            TranslationEntry **usedEntry = nullptr);
+
+    /// Translate the address of an instruction fetch.
+    ExceptionType TranslateFetch(unsigned addr, unsigned *physAddr);
+
+    /// Return where the data at `addr` is in `mainMemory`, if the host
+    /// pointer cache knows it; null otherwise.
+    char *HostAddress(unsigned addr, unsigned size, bool writing);
+
+    /// Translate `addr` the slow way, and remember the result in the host
+    /// pointer cache.
+    ExceptionType HostTranslate(unsigned addr, unsigned size, bool writing,
+                                char **host);
+
+    /// Decoded instructions, by physical address.
+    DecodeCache *decodeCache;
+    bool ownsDecodeCache;
+
+    /// Entry used by the last instruction fetch that went through
+    /// `Translate`.  It is reused as long as it still maps the page of
+    /// the program counter.
+    TranslationEntry *fetchEntry;
+
+    /// Translations of the pages most recently read or written, indexed
+    /// by virtual page number modulo `HOST_CACHE_SIZE`.
+    HostCacheSlot hostCache[HOST_CACHE_SIZE];
+
+    /// Whether translations are being traced (debug flag `a`); in that case
+    /// every fetch goes through `Translate` so that nothing is left out of
+    /// the trace.
+    bool traceTranslation;
+
     unsigned memorySize;
     unsigned numPhysicalPages;
+
+    unsigned tlbSize;  ///< Number of TLB entries.
+    unsigned tlbWays;  ///< Number of entries per set.
+    unsigned tlbSets;  ///< Number of sets.
+    unsigned asid;     ///< Address space whose TLB entries are in use.
 };
 
 
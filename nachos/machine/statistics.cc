@@ -10,6 +10,7 @@
 
 #include "statistics.hh"
 #include "lib/utility.hh"
+#include "system_dep.hh"
 
 #include <stdio.h>
 
@@ -23,6 +24,10 @@ Statistics::Statistics()
     numPageFaults = 0;
     memoryAccess = 0;
     memoryPageFaults = 0;
+    tlbFlushes = 0;
+    numContextSwitches = numPreemptions = 0;
+    numCPUs = 1;
+    cpuBusyTicks = nullptr;
 #ifdef SWAP
     bringFromSwap = 0;
     carryToSwap = 0;
@@ -30,7 +35,30 @@ Statistics::Statistics()
 #ifdef DFS_TICKS_FIX
     tickResets = 0;
 #endif
+    hostStart = SystemDep::HostTime();
+    reportSpeed = false;
+    switchHostTime = 0;
+    numTimedSwitches = 0;
+}
 
+Statistics::~Statistics()
+{
+    delete [] cpuBusyTicks;
+}
+
+void
+Statistics::SetCPUs(unsigned n)
+{
+    ASSERT(n > 0);
+    ASSERT(cpuBusyTicks == nullptr);
+
+    numCPUs = n;
+    if (n > 1) {
+        cpuBusyTicks = new unsigned long [n];
+        for (unsigned i = 0; i < n; i++) {
+            cpuBusyTicks[i] = 0;
+        }
+    }
 }
 
 /// Print performance metrics, when we have finished everything at system
@@ -49,15 +77,38 @@ Statistics::Print()
     printf("Disk I/O: reads %lu, writes %lu\n", numDiskReads, numDiskWrites);
     printf("Console I/O: reads %lu, writes %lu\n",
            numConsoleCharsRead, numConsoleCharsWritten);
+    printf("Context switches: %lu, preemptions %lu\n",
+           numContextSwitches, numPreemptions);
+    if (cpuBusyTicks != nullptr) {
+        for (unsigned i = 0; i < numCPUs; i++) {
+            printf("CPU %u: busy %lu ticks, utilization %.2f%%\n", i,
+                   cpuBusyTicks[i],
+                   totalTicks == 0 ? 0.0
+                                   : 100.0 * cpuBusyTicks[i] / totalTicks);
+        }
+    }
 
 
     printf("Paging: Memory access %lu\n", memoryAccess);
     printf("Paging: faults Memory %lu\n", memoryPageFaults);
     printf("Paging: faults TLB %lu\n", numPageFaults);
     printf("Paging: Hits TLB percentage: %.2lf\n", (double)(memoryAccess-numPageFaults)/memoryAccess * 100);
+#ifdef USE_TLB
+    printf("TLB: hits %lu, misses %lu, flushes %lu\n",
+           memoryAccess - numPageFaults, numPageFaults, tlbFlushes);
+#endif
 #ifdef SWAP
     printf("Paging: Hits Memory percentage: %.2lf\n", (double)(memoryAccess - bringFromSwap)/memoryAccess * 100);
     printf("Swapping: pages carried to swap space: %lu\n", carryToSwap);
     printf("Swapping: pages brought from swap space: %lu\n", bringFromSwap);
 #endif
+    if (reportSpeed) {
+        double seconds = SystemDep::HostTime() - hostStart;
+        printf("Host: %.3f seconds, %.0f user instructions per second\n",
+               seconds, userTicks / seconds);
+        if (numTimedSwitches != 0) {
+            printf("Host: %.0f ns per context switch\n",
+                   switchHostTime * 1e9 / numTimedSwitches);
+        }
+    }
 }
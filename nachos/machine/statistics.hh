@@ -53,6 +53,23 @@ public:
     /// Number of memory page faults.
     unsigned long memoryPageFaults;
 
+    /// Number of times the TLB entries of an address space were flushed.
+    unsigned long tlbFlushes;
+
+    /// Number of times the CPU went from a thread to another.
+    unsigned long numContextSwitches;
+
+    /// Number of those that happened because a thread used up its time
+    /// slice.
+    unsigned long numPreemptions;
+
+    /// Number of CPUs of the machine.
+    unsigned numCPUs;
+
+    /// With more than one CPU, the time each of them spent running
+    /// threads; null otherwise.
+    unsigned long *cpuBusyTicks;
+
 #ifdef SWAP
     /// Number of pages brought from swap space
     unsigned long bringFromSwap;
@@ -66,9 +83,26 @@ public:
     unsigned long tickResets;
 #endif
 
+    /// When Nachos started, in host seconds.
+    double hostStart;
+
+    /// Whether to report how fast user programs ran on the host.
+    bool reportSpeed;
+
+    /// With `reportSpeed`, host seconds spent in `numTimedSwitches`
+    /// context switches, from `Scheduler::Run` in the thread leaving to
+    /// `Scheduler::Run` in the thread arriving (new threads do not count).
+    double switchHostTime;
+    unsigned long numTimedSwitches;
+
     /// Initialize everything to zero.
     Statistics();
 
+    ~Statistics();
+
+    /// Keep track of the time spent by each of `n` CPUs.
+    void SetCPUs(unsigned n);
+
     /// Print collected statistics.
     void Print();
 };
@@ -36,6 +36,8 @@ extern "C" {
 #include <sys/file.h>
 #include <sys/un.h>
 #include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
 #ifdef HOST_i386
 #include <sys/time.h>
 #endif
@@ -338,6 +340,48 @@ Delay(unsigned seconds)
     sleep(seconds);
 }
 
+/// Start a copy of the UNIX process running Nachos.
+///
+/// Return 0 in the copy, and its process identifier in the original.
+int
+Fork()
+{
+    fflush(stdout);  // Otherwise both would print what is buffered.
+    int pid = fork();
+    ASSERT(pid >= 0);
+    return pid;
+}
+
+/// Wait for a copy started with `Fork` to end, and return its exit status,
+/// or -1 if it was killed.
+int
+WaitChild()
+{
+    int status;
+    int pid = wait(&status);
+    ASSERT(pid > 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+unsigned
+HostProcessors()
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? n : 1;
+}
+
+/// Return the time elapsed on the host since some fixed point, in seconds.
+///
+/// Only differences between two calls are meaningful; this is for measuring
+/// how fast the simulation runs, not for the simulated time.
+double
+HostTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
 /// Initialize the pseudo-random number generator.
 ///
 /// We use the now obsolete `srand` and `rand` because they are more
@@ -49,6 +49,19 @@ namespace SystemDep {
 
     void Delay(unsigned seconds);
 
+    /// Host processes: `fork`, and `wait` for any child, returning its exit
+    /// status (-1 if it did not exit normally, for example if it crashed).
+
+    int Fork();
+
+    int WaitChild();
+
+    /// Number of processors of the host.
+    unsigned HostProcessors();
+
+    /// Host clock, for measuring the speed of the simulation.
+    double HostTime();
+
     /// Initialize system so that `cleanUp` routine is called when user hits
     /// Ctrl-C.
     void CallOnUserAbort(VoidNoArgFunctionPtr cleanUp);
@@ -4,7 +4,8 @@
 /// means it can be used for implementing time-slicing.
 ///
 /// We emulate a hardware timer by scheduling an interrupt to occur every
-/// time `stats->totalTicks` has increased by `TIMER_TICKS`.
+/// time `stats->totalTicks` has increased by `TIMER_TICKS`, or by the
+/// period the timer is given.
 ///
 /// In order to introduce some randomness into time-slicing, if `doRandom` is
 /// set, then the interrupt is comes after a random number of ticks.
@@ -42,9 +43,14 @@ TimerHandler(void *arg)
 /// * `callArg` is the parameter to be passed to the interrupt handler.
 /// * `doRandom` -- if true, arrange for the interrupts to occur at random,
 ///   instead of fixed, intervals.
-Timer::Timer(VoidFunctionPtr timerHandler, void *callArg, bool doRandom)
+/// * `aPeriod` -- ticks between interrupts.
+Timer::Timer(VoidFunctionPtr timerHandler, void *callArg, bool doRandom,
+             unsigned long aPeriod)
 {
+    ASSERT(aPeriod > 0);
+
     randomize = doRandom;
+    period    = aPeriod;
     handler   = timerHandler;
     arg       = callArg;
 
@@ -74,8 +80,8 @@ int
 Timer::TimeOfNextInterrupt()
 {
     if (randomize) {
-        return 1 + SystemDep::Random() % (TIMER_TICKS * 2);
+        return 1 + SystemDep::Random() % (period * 2);
     } else {
-        return TIMER_TICKS;
+        return period;
     }
 }
@@ -21,6 +21,7 @@
 #define NACHOS_MACHINE_TIMER__HH
 
 
+#include "statistics.hh"
 #include "lib/utility.hh"
 
 
@@ -29,8 +30,9 @@ class Timer {
 public:
 
     /// Initialize the timer, to call the interrupt handler `timerHandler`
-    /// every time slice.
-    Timer(VoidFunctionPtr timerHandler, void *callArg, bool doRandom);
+    /// every time slice of `period` ticks.
+    Timer(VoidFunctionPtr timerHandler, void *callArg, bool doRandom,
+          unsigned long period = TIMER_TICKS);
 
     ~Timer() {}
 
@@ -44,6 +46,8 @@ public:
 
 private:
     bool randomize;  ///< Set if we need to use a random timeout delay.
+    unsigned long period;  ///< Ticks between interrupts (on average, if
+                           ///< random).
     VoidFunctionPtr handler;  ///< Timer interrupt handler.
     void *arg;  ///< Argument to pass to interrupt handler.
 
@@ -54,6 +54,12 @@ public:
     /// This bit is set by the hardware every time the page is modified.
     bool dirty;
 
+    /// The address space the entry belongs to.  Only looked at in the TLB,
+    /// where entries of several address spaces can live together: an entry
+    /// is only used while its address space is the current one (see
+    /// `MMU::SetASID`).
+    unsigned asid;
+
 };
 
 
@@ -0,0 +1,60 @@
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+
+#include "buffered_channel.hh"
+#include "system.hh"
+
+
+BufferedChannel::BufferedChannel(const char *debugName, unsigned capacity)
+{
+    name = debugName;
+    ring = new SynchRing<int>(capacity);
+}
+
+BufferedChannel::~BufferedChannel()
+{
+    delete ring;
+}
+
+const char *
+BufferedChannel::GetName() const
+{
+    return name;
+}
+
+unsigned
+BufferedChannel::GetCapacity() const
+{
+    return ring->GetCapacity();
+}
+
+void
+BufferedChannel::Send(int message)
+{
+    SendMany(&message, 1);
+}
+
+void
+BufferedChannel::Receive(int *message)
+{
+    ReceiveMany(message, 1);
+}
+
+void
+BufferedChannel::SendMany(const int *messages, unsigned n)
+{
+    DEBUG('c', "Thread \"%s\" sending %u messages on channel \"%s\"\n",
+          currentThread->GetName(), n, name);
+    ring->AppendMany(messages, n);
+}
+
+unsigned
+BufferedChannel::ReceiveMany(int *messages, unsigned max)
+{
+    unsigned n = ring->RemoveMany(messages, max);
+    DEBUG('c', "Thread \"%s\" receiving %u messages on channel \"%s\"\n",
+          currentThread->GetName(), n, name);
+    return n;
+}
@@ -0,0 +1,59 @@
+/// Buffered channels, a synchronization primitive.
+///
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+#ifndef NACHOS_THREADS_BUFFEREDCHANNEL__HH
+#define NACHOS_THREADS_BUFFEREDCHANNEL__HH
+
+
+#include "synch_ring.hh"
+
+
+/// A channel that holds up to `capacity` messages.
+///
+/// Unlike `Channel`, where every `Send` waits for a `Receive` to meet it,
+/// senders only wait while the buffer is full and receivers only while it
+/// is empty.  Messages are received in the order they were sent.
+///
+/// The messages are kept in a `SynchRing`; `SendMany` and `ReceiveMany`
+/// move several of them each time they get its lock, so that a thread woken
+/// up takes everything it can instead of a single message.
+class BufferedChannel {
+public:
+
+    /// Make a channel that buffers up to `capacity` messages; it must be
+    /// at least 1.
+    BufferedChannel(const char *debugName, unsigned capacity);
+
+    ~BufferedChannel();
+
+    const char *GetName() const;
+
+    unsigned GetCapacity() const;
+
+    /// Put `message` in the channel, waiting while it is full.
+    void Send(int message);
+
+    /// Take the oldest message from the channel, waiting while it is empty.
+    void Receive(int *message);
+
+    /// Put the `count` messages in `messages` in the channel, in order.
+    /// Returns once all of them are in, waiting whenever it is full.
+    void SendMany(const int *messages, unsigned count);
+
+    /// Take up to `max` messages and store them in `messages`, waiting
+    /// only if the channel is empty.  Returns how many were taken, which is
+    /// at least 1.
+    unsigned ReceiveMany(int *messages, unsigned max);
+
+private:
+
+    const char *name;
+
+    SynchRing<int> *ring;
+};
+
+
+#endif
@@ -42,15 +42,108 @@
 class Thread;
 #include "thread.hh"
 #include "system.hh"
-/// Dummy functions -- so we can compile our later assignments.
+LockProfile *LockProfile::all = nullptr;
+
+LockProfile::LockProfile(const char *lockName)
+{
+    name = lockName;
+    acquisitions = waits = waitTicks = maxHoldTicks = 0;
+    maxHolder[0] = '\0';
+
+    prev = nullptr;
+    next = all;
+    if (all != nullptr) {
+        all->prev = this;
+    }
+    all = this;
+}
+
+LockProfile::~LockProfile()
+{
+    if (prev != nullptr) {
+        prev->next = next;
+    } else {
+        all = next;
+    }
+    if (next != nullptr) {
+        next->prev = prev;
+    }
+}
+
+void
+LockProfile::Acquired(bool waited, unsigned long since)
+{
+    acquisitions++;
+    if (waited) {
+        waits++;
+        waitTicks += stats->totalTicks - since;
+    }
+}
+
+void
+LockProfile::Released(const Thread *holder, unsigned long since)
+{
+    unsigned long held = stats->totalTicks - since;
+    if (held > maxHoldTicks || maxHolder[0] == '\0') {
+        maxHoldTicks = held;
+        strncpy(maxHolder, holder->GetName(), HOLDER_NAME_SIZE - 1);
+        maxHolder[HOLDER_NAME_SIZE - 1] = '\0';
+    }
+}
+
+void
+LockProfile::PrintHottest(unsigned n)
+{
+    unsigned count = 0;
+    for (LockProfile *p = all; p != nullptr; p = p->next) {
+        count++;
+    }
+    if (n > count) {
+        n = count;
+    }
+
+    // Keep the `n` hottest locks, in order: the longer threads waited for
+    // a lock, the hotter it is, and then the more it was taken.
+    LockProfile **hottest = new LockProfile *[n + 1];
+    unsigned kept = 0;
+    for (LockProfile *p = all; p != nullptr; p = p->next) {
+        unsigned i = kept;
+        while (i > 0
+                 && (p->waitTicks > hottest[i - 1]->waitTicks
+                     || (p->waitTicks == hottest[i - 1]->waitTicks
+                         && p->acquisitions
+                              > hottest[i - 1]->acquisitions))) {
+            hottest[i] = hottest[i - 1];
+            i--;
+        }
+        hottest[i] = p;
+        if (kept < n) {
+            kept++;
+        }
+    }
+
+    printf("Locks: %u, the %u hottest:\n", count, kept);
+    printf("%-24s %12s %8s %12s %10s  %s\n", "Lock", "Acquisitions",
+           "Waits", "Wait ticks", "Max held", "By");
+    for (unsigned i = 0; i < kept; i++) {
+        const LockProfile *p = hottest[i];
+        printf("%-24s %12lu %8lu %12lu %10lu  %s\n", p->name,
+               p->acquisitions, p->waits, p->waitTicks, p->maxHoldTicks,
+               p->maxHolder[0] != '\0' ? p->maxHolder : "-");
+    }
+    delete [] hottest;
+}
 
 Lock::Lock(const char *debugName)
+  : profile(debugName)
 {
     name = debugName;
     owner = nullptr;
     nombre_sem = new char[8 + strlen(debugName)];
     sprintf(nombre_sem, "sem of %s", debugName);
-    sem = new Semaphore(nombre_sem,1);
+    sem = new Semaphore(nombre_sem, 0);
+    waiters = 0;
+    acquiredAt = 0;
 }
 
 Lock::~Lock()
@@ -70,18 +163,29 @@ Lock::Acquire()
 {
     ASSERT(!IsHeldByCurrentThread());
 
-    if(owner && owner->GetPriority() < currentThread->GetPriority()){
-        IntStatus oldLevel = interrupt->SetLevel(INT_OFF);
-        scheduler->UpdateReadyMultiQueue(owner, currentThread->GetPriority());
-        DEBUG('s', "Thread \"%s\" inherited priority of Thread \"%s\" \n", owner->GetName(), currentThread->GetName());
-        interrupt->SetLevel(oldLevel);
-    } 
-
-
+    if (owner == nullptr) {  // Free: nothing else to do.
+        DEBUG('s', "Thread \"%s\" acquired lock \"%s\" \n", currentThread->GetName(), name);
+        owner = currentThread;
+        acquiredAt = stats->totalTicks;
+        profile.Acquired(false, acquiredAt);
+        return;
+    }
 
-    sem->P();
+    IntStatus oldLevel = interrupt->SetLevel(INT_OFF);
+    unsigned long start = stats->totalTicks;
+    while (owner != nullptr) {
+        if (owner->GetPriority() < currentThread->GetPriority()) {
+            scheduler->UpdateReadyMultiQueue(owner, currentThread->GetPriority());
+            DEBUG('s', "Thread \"%s\" inherited priority of Thread \"%s\" \n", owner->GetName(), currentThread->GetName());
+        }
+        waiters++;
+        sem->P();
+    }
     DEBUG('s', "Thread \"%s\" acquired lock \"%s\" \n", currentThread->GetName(), name);
     owner = currentThread;
+    acquiredAt = stats->totalTicks;
+    profile.Acquired(true, start);
+    interrupt->SetLevel(oldLevel);
 }
 
 void
@@ -89,20 +193,25 @@ Lock::Release()
 {
     ASSERT(IsHeldByCurrentThread());
 
-    if(owner->GetOriginalPriority() != owner->GetPriority()){
+    profile.Released(owner, acquiredAt);
+    if(owner->GetOriginalPriority() != owner->GetPriority() || waiters > 0){
         IntStatus oldLevel = interrupt->SetLevel(INT_OFF);
-        DEBUG('s', "Thread \"%s\" retaking its original priority \n", owner->GetName());
-        scheduler->UpdateReadyMultiQueue(owner, owner->GetOriginalPriority());
+        if (owner->GetOriginalPriority() != owner->GetPriority()) {
+            DEBUG('s', "Thread \"%s\" retaking its original priority \n", owner->GetName());
+            scheduler->UpdateReadyMultiQueue(owner, owner->GetOriginalPriority());
+        }
         owner = nullptr;
-        sem->V();
+        if (waiters > 0) {
+            waiters--;
+            sem->V();
+        }
         interrupt->SetLevel(oldLevel);
     } else {
         owner = nullptr;
-        sem->V();
     }
 
     DEBUG('s', "Thread \"%s\" released lock \"%s\" \n", currentThread->GetName(), name);
-    }
+}
 
 bool
 Lock::IsHeldByCurrentThread() const
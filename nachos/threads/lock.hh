@@ -19,6 +19,45 @@
 class Thread;
 #include "semaphore.hh"
 #include "thread.hh"
+
+/// How contended a lock is.  Ticks are those of `stats->totalTicks`.
+///
+/// Profiles of every existing lock are kept in a list, so that the hottest
+/// ones can be reported (see `-lp`).
+class LockProfile {
+public:
+
+    static const unsigned HOLDER_NAME_SIZE = 24;
+
+    LockProfile(const char *lockName);
+    ~LockProfile();
+
+    /// The lock was taken, after waiting since `since` if `waited`.
+    void Acquired(bool waited, unsigned long since);
+
+    /// `holder` gives back the lock it took at `since`.
+    void Released(const Thread *holder, unsigned long since);
+
+    /// Print the profiles of the `n` existing locks threads waited on the
+    /// longest.
+    static void PrintHottest(unsigned n);
+
+private:
+    const char *name;
+
+    unsigned long acquisitions;
+    unsigned long waits;         ///< Acquisitions that had to wait.
+    unsigned long waitTicks;     ///< Time spent waiting, all in all.
+    unsigned long maxHoldTicks;  ///< Longest time it was held...
+    char maxHolder[HOLDER_NAME_SIZE];  ///< ...and by which thread (the
+                                       ///< name is copied, the thread may
+                                       ///< be gone).
+
+    static LockProfile *all;
+    LockProfile *next;
+    LockProfile *prev;
+};
+
 /// This class defines a “lock”.
 ///
 /// A lock can have two states: free and busy. Only two operations are
@@ -30,6 +69,13 @@ class Thread;
 ///
 /// For convenience, nobody but the thread that holds the lock can free it.
 /// There is no operation for reading the state of the lock.
+///
+/// Taking a free lock only marks it as taken: as there is no preemption in
+/// between, that needs neither disabling interrupts nor the semaphore, which
+/// is only used for waiting.  A thread woken up when the lock is released
+/// has to try again, since another one may have taken it in the meantime.
+///
+/// Every lock keeps count of how contended it is; see `LockProfile`.
 class Lock {
 public:
 
@@ -60,6 +106,12 @@ private:
     Thread *owner;
     Semaphore *sem;
     char *nombre_sem;
+
+    /// Threads waiting on `sem`.
+    unsigned waiters;
+
+    unsigned long acquiredAt;  ///< When the owner got the lock.
+    LockProfile profile;
 };
 
 
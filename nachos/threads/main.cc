@@ -11,9 +11,15 @@
 /// =====
 ///
 ///     nachos [-d <debugflags>] [-do <debugopts>] 
-///            [-rs <random seed #>] [-z] [-tt|-tN] 
-///            [-m <num phys pages>]
-///            [-s] [-x <nachos file>] [-tc <consoleIn> <consoleOut>] 
+///            [-rs <random seed #>] [-sched <priority|mlfq|stride>] [-rt]
+///            [-q <ticks>] [-qp <priority> <timer interrupts>]
+///            [-sp <stacks>] [-lp]
+///            [-z] [-tt|-tN]
+///            [-m <num phys pages>] [-tlb <num entries>] [-tlbw <ways>]
+///            [-tlbp <fifo|random|lru|nru>]
+///            [-prp <fifo|random|clock|aging|wsclock>] [-cpus <num cpus>]
+///            [-s] [-bb] [-ips] [-x <nachos file>] [-xn <count> <nachos file>]
+///            [-tc <consoleIn> <consoleOut>]
 ///            [-f] [-cp <unix file> <nachos file>] [-pr <nachos file>]
 ///            [-rm <nachos file>] [-ls] [-D] [-c] [-tf]
 ///
@@ -25,6 +31,25 @@
 /// * `-do` -- enables options that modify the behavior when printing
 ///            debugging messages.
 /// * `-rs` -- causes `Yield` to occur at random (but repeatable) spots.
+/// * `-sched` -- scheduling policy: `priority` (the default), `mlfq`
+///            (multi-level feedback queue) or `stride` (proportional share,
+///            see `ExecWeighted`); the last two slice time.
+/// * `-rt` -- prints how long each thread waited for the CPU, when it
+///            finishes.
+/// * `-q`  -- preempts the running thread every given number of ticks
+///            (instead of at random, as `-rs` does); with `-rs` too, the
+///            timer interrupts at random, that many ticks apart on average.
+/// * `-qp` -- makes the time slice of threads of a priority (or MLFQ level)
+///            last the given number of timer interrupts, instead of 1.  The
+///            priority must be below 10 and the number positive, and there
+///            must be a timer: `-q`, `-rs`, or `mlfq` or `stride`
+///            scheduling.
+/// * `-sp` -- how many stacks of finished threads of each size are kept
+///            for new threads to reuse; 0 gives them back to the host
+///            right away.
+/// * `-lp` -- prints, when halting, the locks threads waited for the
+///            longest, with how many times they were taken and waited for,
+///            and the longest time one was held.
 /// * `-z`  -- prints version and copyright information, and exits.
 /// * `-m`  -- size of emulated physical memory (in pages)
 ///
@@ -39,7 +64,28 @@
 /// ----------------------
 ///
 /// * `-s`  -- causes user programs to be executed in single-step mode.
+/// * `-bb` -- executes user programs a basic block at a time, rather than an
+///            instruction at a time; faster, with the same simulated timing.
+/// * `-tlb` -- number of TLB entries, if there is a TLB.
+/// * `-tlbw` -- entries per TLB set (set associative TLB), at least 2; by
+///            default the TLB is fully associative.
+/// * `-tlbp` -- TLB replacement policy: `fifo` (the default), `random`,
+///            `lru` (approximated by aging the use bits) or `nru`.
+/// * `-prp` -- page replacement policy, when memory is full: `fifo`,
+///            `random` (the default without *VMEM*), `clock` (enhanced
+///            clock, the default with *VMEM*), `aging` (LRU approximated
+///            by sampling the use bits into counters) or `wsclock`
+///            (working set, by the virtual time of each process).
+/// * `-cpus` -- number of simulated CPUs, each with its own registers,
+///            MMU and run queue; the utilization of each is reported when
+///            halting.
+/// * `-ips` -- reports how many user instructions were run per second of
+///            host time, when halting.
 /// * `-x`  -- runs a user program.
+/// * `-xn` -- runs that many independent instances of a user program, in
+///            parallel, each in a host process of its own; an instance
+///            fails if its program could not be started, crashed, or passed
+///            a status other than 0 to `Exit`.
 /// * `-tc` -- tests the console.
 ///
 /// *FILESYS* options
@@ -74,7 +120,7 @@
 
 #include <stdio.h>
 #include <string.h>
-#ifdef THREADS
+#if defined(THREADS) || defined(USER_PROGRAM)
     #include <stdlib.h>
 #endif
 
@@ -85,6 +131,7 @@ void Copy(const char *unixFile, const char *nachosFile);
 void Print(const char *file);
 void PerformanceTest(void);
 void StartProcess(const char *file);
+void StartBatch(const char *file, unsigned count);
 void ConsoleTest(const char *in, const char *out);
 
 static inline void
@@ -140,6 +187,10 @@ main(int argc, char **argv)
             ASSERT(argc > 1);
             StartProcess(*(argv + 1));
             argCount = 2;
+        } else if (!strcmp(*argv, "-xn")) {  // Run a batch of programs.
+            ASSERT(argc > 2);
+            StartBatch(*(argv + 2), atoi(*(argv + 1)));
+            argCount = 3;
         } else if (!strcmp(*argv, "-tc")) {  // Test the console.
             if (argc == 1) {
                 ConsoleTest(nullptr, nullptr);
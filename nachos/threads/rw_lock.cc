@@ -0,0 +1,233 @@
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+
+#include "rw_lock.hh"
+#include "system.hh"
+
+#include <string.h>
+
+
+/// Room for readers the lock starts with; it grows as needed.
+static const unsigned INITIAL_READERS = 4;
+
+static char *
+CopyName(const char *debugName)
+{
+    ASSERT(debugName != nullptr);
+    char *copy = new char [strlen(debugName) + 1];
+    strcpy(copy, debugName);
+    return copy;
+}
+
+RWLock::RWLock(const char *debugName)
+  : name(CopyName(debugName)), profile(name)
+{
+    writer = nullptr;
+    writtenSince = 0;
+    readersSize = INITIAL_READERS;
+    readers = new Thread *[readersSize];
+    readSince = new unsigned long [readersSize];
+    numReaders = 0;
+    pendingWriters = 0;
+    sleepingReaders = sleepingWriters = 0;
+    readersSem = new Semaphore("readers of rwlock", 0);
+    writersSem = new Semaphore("writers of rwlock", 0);
+}
+
+RWLock::~RWLock()
+{
+    delete [] readers;
+    delete [] readSince;
+    delete readersSem;
+    delete writersSem;
+    delete [] name;
+}
+
+const char *
+RWLock::GetName() const
+{
+    return name;
+}
+
+void
+RWLock::Inherit()
+{
+    int p = currentThread->GetPriority();
+    if (writer != nullptr && writer->GetPriority() < p) {
+        scheduler->UpdateReadyMultiQueue(writer, p);
+        DEBUG('s', "Thread \"%s\" inherited priority of Thread \"%s\"\n",
+              writer->GetName(), currentThread->GetName());
+    }
+    for (unsigned i = 0; i < numReaders; i++) {
+        if (readers[i]->GetPriority() < p) {
+            scheduler->UpdateReadyMultiQueue(readers[i], p);
+            DEBUG('s', "Thread \"%s\" inherited priority of Thread \"%s\"\n",
+                  readers[i]->GetName(), currentThread->GetName());
+        }
+    }
+}
+
+void
+RWLock::Restore(Thread *thread)
+{
+    if (thread->GetOriginalPriority() != thread->GetPriority()) {
+        DEBUG('s', "Thread \"%s\" retaking its original priority\n",
+              thread->GetName());
+        scheduler->UpdateReadyMultiQueue(thread,
+                                         thread->GetOriginalPriority());
+    }
+}
+
+void
+RWLock::Wake()
+{
+    if (sleepingWriters > 0) {
+        sleepingWriters--;
+        writersSem->V();
+    } else {
+        while (sleepingReaders > 0) {
+            sleepingReaders--;
+            readersSem->V();
+        }
+    }
+}
+
+void
+RWLock::AcquireRead()
+{
+    ASSERT(!IsHeldByCurrentThread() && !IsReadByCurrentThread());
+
+    bool waited = false;
+    unsigned long start = stats->totalTicks;
+    IntStatus oldLevel = INT_ON;
+    if (writer != nullptr || pendingWriters > 0) {
+        oldLevel = interrupt->SetLevel(INT_OFF);
+        waited = true;
+        while (writer != nullptr || pendingWriters > 0) {
+            Inherit();
+            sleepingReaders++;
+            readersSem->P();
+        }
+    }
+
+    if (numReaders == readersSize) {
+        Thread **newReaders = new Thread *[readersSize * 2];
+        unsigned long *newSince = new unsigned long [readersSize * 2];
+        for (unsigned i = 0; i < numReaders; i++) {
+            newReaders[i] = readers[i];
+            newSince[i] = readSince[i];
+        }
+        delete [] readers;
+        delete [] readSince;
+        readers = newReaders;
+        readSince = newSince;
+        readersSize *= 2;
+    }
+    readers[numReaders] = currentThread;
+    readSince[numReaders] = stats->totalTicks;
+    numReaders++;
+    profile.Acquired(waited, start);
+    DEBUG('s', "Thread \"%s\" acquired rwlock \"%s\" for reading\n",
+          currentThread->GetName(), name);
+
+    if (waited) {
+        interrupt->SetLevel(oldLevel);
+    }
+}
+
+void
+RWLock::ReleaseRead()
+{
+    unsigned i = 0;
+    while (i < numReaders && readers[i] != currentThread) {
+        i++;
+    }
+    ASSERT(i < numReaders);
+
+    profile.Released(currentThread, readSince[i]);
+    numReaders--;
+    readers[i] = readers[numReaders];
+    readSince[i] = readSince[numReaders];
+
+    bool restore = currentThread->GetOriginalPriority()
+                     != currentThread->GetPriority();
+    if (restore || (numReaders == 0 && sleepingWriters > 0)) {
+        IntStatus oldLevel = interrupt->SetLevel(INT_OFF);
+        Restore(currentThread);
+        if (numReaders == 0) {
+            Wake();
+        }
+        interrupt->SetLevel(oldLevel);
+    }
+    DEBUG('s', "Thread \"%s\" released rwlock \"%s\" for reading\n",
+          currentThread->GetName(), name);
+}
+
+void
+RWLock::AcquireWrite()
+{
+    ASSERT(!IsHeldByCurrentThread() && !IsReadByCurrentThread());
+
+    if (writer == nullptr && numReaders == 0) {  // Free.
+        writer = currentThread;
+        writtenSince = stats->totalTicks;
+        profile.Acquired(false, writtenSince);
+        DEBUG('s', "Thread \"%s\" acquired rwlock \"%s\" for writing\n",
+              currentThread->GetName(), name);
+        return;
+    }
+
+    IntStatus oldLevel = interrupt->SetLevel(INT_OFF);
+    unsigned long start = stats->totalTicks;
+    pendingWriters++;
+    while (writer != nullptr || numReaders > 0) {
+        Inherit();
+        sleepingWriters++;
+        writersSem->P();
+    }
+    pendingWriters--;
+    writer = currentThread;
+    writtenSince = stats->totalTicks;
+    profile.Acquired(true, start);
+    DEBUG('s', "Thread \"%s\" acquired rwlock \"%s\" for writing\n",
+          currentThread->GetName(), name);
+    interrupt->SetLevel(oldLevel);
+}
+
+void
+RWLock::ReleaseWrite()
+{
+    ASSERT(IsHeldByCurrentThread());
+
+    profile.Released(writer, writtenSince);
+    writer = nullptr;
+    bool restore = currentThread->GetOriginalPriority()
+                     != currentThread->GetPriority();
+    if (restore || sleepingWriters > 0 || sleepingReaders > 0) {
+        IntStatus oldLevel = interrupt->SetLevel(INT_OFF);
+        Restore(currentThread);
+        Wake();
+        interrupt->SetLevel(oldLevel);
+    }
+    DEBUG('s', "Thread \"%s\" released rwlock \"%s\" for writing\n",
+          currentThread->GetName(), name);
+}
+
+bool
+RWLock::IsHeldByCurrentThread() const
+{
+    return writer == currentThread;
+}
+
+bool
+RWLock::IsReadByCurrentThread() const
+{
+    for (unsigned i = 0; i < numReaders; i++) {
+        if (readers[i] == currentThread) {
+            return true;
+        }
+    }
+    return false;
+}
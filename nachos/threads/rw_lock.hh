@@ -0,0 +1,88 @@
+/// Readers-writer lock, a synchronization primitive.
+///
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+#ifndef NACHOS_THREADS_RWLOCK__HH
+#define NACHOS_THREADS_RWLOCK__HH
+
+
+#include "lock.hh"
+
+
+/// A lock that can be held by many readers at once, or by a single writer.
+///
+/// Writers go first: once a writer is waiting, new readers wait too, so that
+/// a steady stream of readers cannot starve it.  When the lock is given
+/// back, a waiting writer is woken up if there is one, and every waiting
+/// reader otherwise.
+///
+/// As with `Lock`, taking a lock that is free needs neither disabling
+/// interrupts nor the semaphores, and a thread that waits lends its
+/// priority to the ones holding the lock, which get their own back when
+/// they release it.
+///
+/// A thread cannot take the lock again while holding it, in either mode.
+class RWLock {
+public:
+
+    /// The lock keeps a copy of `debugName`, so that it may be built in a
+    /// buffer of the caller (as the name of each sector of the disk is).
+    RWLock(const char *debugName);
+
+    ~RWLock();
+
+    /// For debugging.
+    const char *GetName() const;
+
+    void AcquireRead();
+    void ReleaseRead();
+
+    void AcquireWrite();
+    void ReleaseWrite();
+
+    /// Whether the current thread holds the lock as the writer.
+    bool IsHeldByCurrentThread() const;
+
+    /// Whether the current thread is one of the readers holding the lock.
+    bool IsReadByCurrentThread() const;
+
+private:
+
+    /// Lend the priority of the current thread, which is about to wait, to
+    /// the threads holding the lock.
+    void Inherit();
+
+    /// `thread` gives back its part of the lock.
+    void Restore(Thread *thread);
+
+    /// The lock is free: wake up the threads that can take it.
+    void Wake();
+
+    char *name;
+
+    Thread *writer;
+    unsigned long writtenSince;  ///< When the writer got the lock.
+
+    /// Threads holding the lock for reading, and when they got it.
+    Thread **readers;
+    unsigned long *readSince;
+    unsigned numReaders;
+    unsigned readersSize;
+
+    /// Writers trying to get the lock; readers wait while there is any.
+    unsigned pendingWriters;
+
+    /// Threads waiting on each semaphore that have not been signalled.
+    unsigned sleepingReaders;
+    unsigned sleepingWriters;
+
+    Semaphore *readersSem;
+    Semaphore *writersSem;
+
+    LockProfile profile;
+};
+
+
+#endif
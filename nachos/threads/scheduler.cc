@@ -9,8 +9,16 @@
 /// needed to wait for a lock, and the lock was busy, we would end up calling
 /// `FindNextToRun`, and that would put us in an infinite loop.
 ///
-/// Very simple implementation -- no priorities, straight FIFO.  Might need
-/// to be improved in later assignments.
+/// Threads are kept in one FIFO queue per priority, and the highest
+/// priority with ready threads is found from a bitmap, so that every
+/// operation takes constant time whatever the number of threads.
+///
+/// With several CPUs, each has its own queues.  A thread goes back to the
+/// queues of the CPU it last ran on, and a CPU that runs out of threads
+/// steals one from the CPU with most of them.  CPUs take turns running
+/// (see `Interleave`), but only ever between user instructions, so the
+/// kernel still runs on one CPU at a time and disabling interrupts is
+/// still enough for mutual exclusion.
 ///
 /// Copyright (c) 1992-1993 The Regents of the University of California.
 ///               2016-2021 Docentes de la Universidad Nacional de Rosario.
@@ -25,21 +33,223 @@
 
 
 /// Initialize the multi queue of ready but not running threads to empty.
-Scheduler::Scheduler(int priorities)
+Scheduler::Scheduler(int priorities, SchedulingPolicy aPolicy,
+                     unsigned cpus)
 {
-    readyMultiQueue = new List<Thread *>* [priorities];
-    for(int i = 0; i < priorities; i++)
-        readyMultiQueue[i] = new List<Thread *>; 
+    ASSERT(priorities > 0 && priorities <= MAX_PRIORITIES);
+    ASSERT(cpus > 0);
+
+    readyMultiQueue = new ReadyQueue [priorities * cpus];
+    for (unsigned i = 0; i < priorities * cpus; i++) {
+        readyMultiQueue[i].head = readyMultiQueue[i].tail = nullptr;
+    }
+    quantum = new unsigned [priorities];
+    for(int i = 0; i < priorities; i++) {
+        quantum[i] = 1;
+    }
     numberOfPriorities = priorities;
+    numCPUs = cpus;
+    currentCPU = 0;
+    readyLevels = new unsigned [cpus];
+    readyCount = new unsigned [cpus];
+    cpuThread = new Thread *[cpus];
+    for (unsigned i = 0; i < cpus; i++) {
+        readyLevels[i] = readyCount[i] = 0;
+        cpuThread[i] = nullptr;
+    }
+    policy = aPolicy;
+    mlfqEpoch = 1;
+    nextBoost = MLFQ_BOOST_TICKS;
+    strideCapacity = 8;
+    strideHeap = new Thread *[strideCapacity];
+    strideSize = 0;
+    globalPass = 0;
+    reportResponse = false;
+    keepSpace = false;
+    switchStart = 0;
 }
 
 /// De-allocate the multi queue of ready threads.
 Scheduler::~Scheduler()
 {
-    for(int i = 0; i < numberOfPriorities; i++)
-    	delete readyMultiQueue[i];
     delete [] readyMultiQueue;
-    
+    delete [] strideHeap;
+    delete [] quantum;
+    delete [] readyLevels;
+    delete [] readyCount;
+    delete [] cpuThread;
+}
+
+void
+Scheduler::HeapPush(Thread *thread)
+{
+    if (strideSize == strideCapacity) {
+        Thread **bigger = new Thread *[strideCapacity * 2];
+        for (unsigned i = 0; i < strideSize; i++) {
+            bigger[i] = strideHeap[i];
+        }
+        delete [] strideHeap;
+        strideHeap = bigger;
+        strideCapacity *= 2;
+    }
+
+    unsigned i = strideSize++;
+    while (i > 0 && thread->pass < strideHeap[(i - 1) / 2]->pass) {
+        strideHeap[i] = strideHeap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    strideHeap[i] = thread;
+}
+
+Thread *
+Scheduler::HeapPop()
+{
+    ASSERT(strideSize > 0);
+
+    Thread *min = strideHeap[0];
+    Thread *last = strideHeap[--strideSize];
+    unsigned i = 0;
+    for (;;) {
+        unsigned child = 2 * i + 1;
+        if (child >= strideSize) {
+            break;
+        }
+        if (child + 1 < strideSize
+              && strideHeap[child + 1]->pass < strideHeap[child]->pass) {
+            child++;
+        }
+        if (last->pass <= strideHeap[child]->pass) {
+            break;
+        }
+        strideHeap[i] = strideHeap[child];
+        i = child;
+    }
+    strideHeap[i] = last;
+    return min;
+}
+
+void
+Scheduler::ChargePass(Thread *thread)
+{
+    thread->pass += (stats->totalTicks - thread->dispatchedAt)
+                    * (STRIDE1 / thread->GetWeight());
+}
+
+Scheduler::ReadyQueue *
+Scheduler::QueuesOf(unsigned cpu) const
+{
+    return &readyMultiQueue[cpu * numberOfPriorities];
+}
+
+/// Append `thread` to the ready queue of priority `p`.
+void
+Scheduler::Enqueue(Thread *thread, int p)
+{
+    ReadyQueue *q = &QueuesOf(thread->cpu)[p];
+    thread->readyNext = nullptr;
+    thread->readyPrev = q->tail;
+    if (q->tail == nullptr) {
+        q->head = thread;
+    } else {
+        q->tail->readyNext = thread;
+    }
+    q->tail = thread;
+    readyLevels[thread->cpu] |= 1U << p;
+    readyCount[thread->cpu]++;
+}
+
+/// Take `thread` out of the ready queue of priority `p`, wherever it is.
+void
+Scheduler::Dequeue(Thread *thread, int p)
+{
+    ReadyQueue *q = &QueuesOf(thread->cpu)[p];
+    if (thread->readyPrev == nullptr) {
+        ASSERT(q->head == thread);
+        q->head = thread->readyNext;
+    } else {
+        thread->readyPrev->readyNext = thread->readyNext;
+    }
+    if (thread->readyNext == nullptr) {
+        ASSERT(q->tail == thread);
+        q->tail = thread->readyPrev;
+    } else {
+        thread->readyNext->readyPrev = thread->readyPrev;
+    }
+    thread->readyNext = thread->readyPrev = nullptr;
+    if (q->head == nullptr) {
+        readyLevels[thread->cpu] &= ~(1U << p);
+    }
+    readyCount[thread->cpu]--;
+}
+
+/// Return the MLFQ level of `thread`: the top one if there was a boost
+/// since it was last set.
+int
+Scheduler::MlfqLevel(Thread *thread) const
+{
+    return thread->mlfqEpoch == mlfqEpoch ? thread->mlfqLevel
+                                          : numberOfPriorities - 1;
+}
+
+/// Set the MLFQ level of `thread`, which must not be in a ready queue.
+void
+Scheduler::SetMlfqLevel(Thread *thread, int level)
+{
+    if (level < 0) {
+        level = 0;
+    } else if (level >= numberOfPriorities) {
+        level = numberOfPriorities - 1;
+    }
+    thread->mlfqLevel = level;
+    thread->mlfqEpoch = mlfqEpoch;
+}
+
+int
+Scheduler::QueueOf(Thread *thread) const
+{
+    if (policy != MLFQ_SCHEDULING) {
+        return thread->GetPriority();
+    }
+
+    int level = MlfqLevel(thread);
+    if (thread->GetPriority() > thread->GetOriginalPriority()
+          && thread->GetPriority() > level) {
+        return thread->GetPriority();  // Inherited from a lock.
+    }
+    return level;
+}
+
+/// Start a new MLFQ epoch, which puts every thread back at the top level,
+/// and move the ready threads to the top queue, keeping their order.
+/// Each queue is spliced as a whole, so this takes time proportional to
+/// the number of levels, not of threads.
+void
+Scheduler::Boost()
+{
+    DEBUG('t', "Boosting every thread to the top level\n");
+
+    mlfqEpoch++;
+    for (unsigned cpu = 0; cpu < numCPUs; cpu++) {
+        ReadyQueue *queues = QueuesOf(cpu);
+        ReadyQueue *top = &queues[numberOfPriorities - 1];
+        for (int i = numberOfPriorities - 2; i >= 0; i--) {
+            ReadyQueue *q = &queues[i];
+            if (q->head == nullptr) {
+                continue;
+            }
+            if (top->tail == nullptr) {
+                top->head = q->head;
+            } else {
+                top->tail->readyNext = q->head;
+                q->head->readyPrev = top->tail;
+            }
+            top->tail = q->tail;
+            q->head = q->tail = nullptr;
+        }
+        if (readyLevels[cpu] != 0) {
+            readyLevels[cpu] = 1U << (numberOfPriorities - 1);
+        }
+    }
 }
 
 /// Mark a thread as ready, but not running.
@@ -53,10 +263,31 @@ Scheduler::ReadyToRun(Thread *thread)
 
     DEBUG('t', "Putting thread %s on ready list\n", thread->GetName());
 
+    ASSERT(thread->GetStatus() != READY);
+      // A thread can only be in one ready queue, once.
+
+    if (thread->GetStatus() == JUST_CREATED) {
+        thread->cpu = LeastLoadedCPU();
+    }
+
+    if (policy == MLFQ_SCHEDULING && thread == currentThread
+          && thread->sliceExpired) {
+        // It used up a whole time slice.
+        SetMlfqLevel(thread, MlfqLevel(thread) - 1);
+    }
+
     thread->SetStatus(READY);
-    int p = thread->GetPriority();
+    thread->readySince = stats->totalTicks;
+    if (policy == STRIDE_SCHEDULING) {
+        if (thread != currentThread && thread->pass < globalPass) {
+            thread->pass = globalPass;
+        }
+        HeapPush(thread);
+        return;
+    }
+    int p = QueueOf(thread);
     ASSERT(p >= 0 && p < numberOfPriorities);
-    readyMultiQueue[p]->Append(thread);
+    Enqueue(thread, p);
 }
 
 /// Return the next thread to be scheduled onto the CPU.
@@ -65,14 +296,91 @@ Scheduler::ReadyToRun(Thread *thread)
 ///
 /// Side effect: thread is removed from the ready multiqueue.
 Thread *
-Scheduler::FindNextToRun()
+Scheduler::FindNextToRun(Thread *yielding)
+{
+    if (policy == STRIDE_SCHEDULING) {
+        if (yielding != nullptr) {
+            // Keep running unless someone is behind.
+            ChargePass(yielding);
+            yielding->cpuTicks += stats->totalTicks - yielding->dispatchedAt;
+            yielding->dispatchedAt = stats->totalTicks;
+            if (strideSize == 0 || yielding->pass <= strideHeap[0]->pass) {
+                StartSlice(yielding);
+                return nullptr;
+            }
+        }
+    } else if (yielding != nullptr && readyLevels[currentCPU] == 0) {
+        StartSlice(yielding);  // It keeps the CPU for another slice.
+        return nullptr;
+    }
+    return TakeReady(currentCPU);
+}
+
+Thread *
+Scheduler::TakeReady(unsigned cpu)
 {
-    for(int i = numberOfPriorities; i > 0; i--){
-        if(!readyMultiQueue[i-1]->IsEmpty())
-	        return readyMultiQueue[i-1]->Pop();	    
+    if (policy == STRIDE_SCHEDULING) {
+        if (strideSize == 0) {
+            return nullptr;
         }
+        Thread *thread = HeapPop();
+        globalPass = thread->pass;
+        return thread;
+    }
+
+    if (readyLevels[cpu] == 0) {
+        return Steal(cpu);
+    }
+
+    if (policy == MLFQ_SCHEDULING && stats->totalTicks >= nextBoost) {
+        Boost();
+        nextBoost = stats->totalTicks + MLFQ_BOOST_TICKS;
+    }
+
+    // The highest set bit is the highest priority with ready threads.
+    int p = 31 - __builtin_clz(readyLevels[cpu]);
+    Thread *thread = QueuesOf(cpu)[p].head;
+    Dequeue(thread, p);
+    return thread;
+}
+
+/// Take the last thread of the highest priority of the CPU with most ready
+/// threads: the one that would have to wait the longest there.
+Thread *
+Scheduler::Steal(unsigned cpu)
+{
+    unsigned victim = cpu;
+    for (unsigned i = 0; i < numCPUs; i++) {
+        if (readyCount[i] > readyCount[victim]) {
+            victim = i;
+        }
+    }
+    if (readyCount[victim] == 0) {
+        return nullptr;
+    }
 
-    return nullptr;
+    int p = 31 - __builtin_clz(readyLevels[victim]);
+    Thread *thread = QueuesOf(victim)[p].tail;
+    Dequeue(thread, p);
+    thread->cpu = cpu;
+    DEBUG('t', "CPU %u steals thread \"%s\" from CPU %u\n",
+          cpu, thread->GetName(), victim);
+    return thread;
+}
+
+unsigned
+Scheduler::LeastLoadedCPU() const
+{
+    unsigned best = 0, bestLoad = ~0U;
+    for (unsigned i = 0; i < numCPUs; i++) {
+        bool busy = i == currentCPU || cpuThread[i] != nullptr;
+        unsigned load = readyCount[i] + busy;
+        if (load < bestLoad) {
+            best = i;
+            bestLoad = load;
+        }
+    }
+    return best;
 }
 
 /// Dispatch the CPU to `nextThread`.
@@ -93,19 +401,25 @@ Scheduler::Run(Thread *nextThread)
 
     Thread *oldThread = currentThread;
 
-#ifdef USER_PROGRAM  // Ignore until running user programs.
-    if (currentThread->space != nullptr) {
-        // If this thread is a user program, save the user's CPU registers.
-        currentThread->SaveUserState();
-        currentThread->space->SaveState();
+    if (stats->reportSpeed) {
+        switchStart = SystemDep::HostTime();
     }
+#ifdef USER_PROGRAM
+    // An address space belongs to a single thread, so if it is the one
+    // coming back, the MMU can be left as it is.
+    keepSpace = nextThread->space != nullptr
+                  && nextThread->space == oldThread->space;
 #endif
-
-    oldThread->CheckOverflow();  // Check if the old thread had an undetected
-                                 // stack overflow.
+    Descheduled(oldThread);
+    if (oldThread != nextThread) {
+        stats->numContextSwitches++;
+        if (oldThread->sliceExpired) {
+            stats->numPreemptions++;
+        }
+    }
 
     currentThread = nextThread;  // Switch to the next thread.
-    currentThread->SetStatus(RUNNING);  // `nextThread` is now running.
+    Dispatch(nextThread, currentCPU);  // `nextThread` is now running.
 
     DEBUG('t', "Switching from thread \"%s\" to thread \"%s\"\n",
           oldThread->GetName(), nextThread->GetName());
@@ -119,6 +433,59 @@ Scheduler::Run(Thread *nextThread)
 
     DEBUG('t', "Now in thread \"%s\"\n", currentThread->GetName());
 
+    Resume();
+
+    if (switchStart != 0) {
+        stats->switchHostTime += SystemDep::HostTime() - switchStart;
+        stats->numTimedSwitches++;
+        switchStart = 0;
+    }
+}
+
+/// `thread` is leaving the CPU: save its user state, and account for the
+/// time it ran.
+void
+Scheduler::Descheduled(Thread *thread)
+{
+#ifdef USER_PROGRAM  // Ignore until running user programs.
+    if (thread->space != nullptr) {
+        // If this thread is a user program, save the user's CPU registers.
+        thread->SaveUserState();
+        if (!keepSpace) {
+            thread->space->SaveState();
+        }
+    }
+#endif
+
+    thread->CheckOverflow();  // Check if the old thread had an undetected
+                              // stack overflow.
+
+    if (policy == STRIDE_SCHEDULING) {
+        ChargePass(thread);
+    }
+    thread->cpuTicks += stats->totalTicks - thread->dispatchedAt;
+}
+
+/// `thread` gets CPU `cpu`.
+void
+Scheduler::Dispatch(Thread *thread, unsigned cpu)
+{
+    thread->SetStatus(RUNNING);
+    thread->cpu = cpu;
+
+    unsigned long wait = stats->totalTicks - thread->readySince;
+    thread->totalWait += wait;
+    if (wait > thread->maxWait) {
+        thread->maxWait = wait;
+    }
+    thread->dispatches++;
+    thread->dispatchedAt = stats->totalTicks;
+    StartSlice(thread);
+}
+
+void
+Scheduler::Resume()
+{
     // If the old thread gave up the processor because it was finishing, we
     // need to delete its carcass.  Note we cannot delete the thread before
     // now (for example, in `Thread::Finish`), because up to this point, we
@@ -132,11 +499,118 @@ Scheduler::Run(Thread *nextThread)
     if (currentThread->space != nullptr) {
         // If there is an address space to restore, do it.
         currentThread->RestoreUserState();
-        currentThread->space->RestoreState();
+        if (!keepSpace) {
+            currentThread->space->RestoreState();
+        }
     }
+    keepSpace = false;
 #endif
 }
 
+/// Switch the host to CPU `cpu`, which goes on running `nextThread`.
+///
+/// The current thread stays where it is, as the thread of its CPU if it
+/// still has one.  It goes on from here when its CPU gets another turn, or,
+/// if it left the CPU, once it is dispatched again.
+void
+Scheduler::SwitchCPU(unsigned cpu, Thread *nextThread)
+{
+    ASSERT(cpu != currentCPU);
+    ASSERT(nextThread != nullptr);
+
+    Thread *oldThread = currentThread;
+    oldThread->CheckOverflow();
+
+    cpuThread[cpu] = nullptr;  // It becomes the current CPU.
+    currentCPU = cpu;
+    keepSpace = false;  // The thread resumed has an MMU of its own.
+    switchStart = 0;
+#ifdef USER_PROGRAM
+    machine->SetCPU(cpu);
+#endif
+    interrupt->SwitchCPU(cpu);
+    currentThread = nextThread;
+
+    DEBUG('t', "Switching to CPU %u, thread \"%s\"\n",
+          cpu, nextThread->GetName());
+
+    SWITCH(oldThread, nextThread);
+
+    DEBUG('t', "Now in thread \"%s\", CPU %u\n",
+          currentThread->GetName(), currentCPU);
+
+    if (threadToBeDestroyed != nullptr) {
+        delete threadToBeDestroyed;
+        threadToBeDestroyed = nullptr;
+    }
+}
+
+unsigned
+Scheduler::EarliestCPU() const
+{
+    unsigned earliest = currentCPU;
+    for (unsigned i = 0; i < numCPUs; i++) {
+        if (cpuThread[i] != nullptr
+              && (earliest == currentCPU
+                  || interrupt->GetClock(i) < interrupt->GetClock(earliest))) {
+            earliest = i;
+        }
+    }
+    return earliest;
+}
+
+void
+Scheduler::Interleave()
+{
+    ASSERT(interrupt->GetLevel() == INT_OFF);
+
+    // An idle CPU that can find something to run goes first.
+    for (unsigned i = 1; i < numCPUs; i++) {
+        unsigned cpu = (currentCPU + i) % numCPUs;
+        if (cpuThread[cpu] != nullptr) {
+            continue;
+        }
+        Thread *thread = TakeReady(cpu);
+        if (thread != nullptr) {
+            DEBUG('t', "CPU %u wakes up\n", cpu);
+            cpuThread[currentCPU] = currentThread;
+            interrupt->StartCPU(cpu);
+            Dispatch(thread, cpu);
+            SwitchCPU(cpu, thread);
+            return;
+        }
+    }
+
+    unsigned cpu = EarliestCPU();
+    if (cpu != currentCPU
+          && interrupt->GetClock(cpu) < interrupt->GetClock(currentCPU)) {
+        cpuThread[currentCPU] = currentThread;
+        SwitchCPU(cpu, cpuThread[cpu]);
+    } else {
+        interrupt->SwitchCPU(currentCPU);  // Another turn.
+    }
+}
+
+bool
+Scheduler::LeaveCPU()
+{
+    if (numCPUs == 1) {
+        return false;
+    }
+    unsigned cpu = EarliestCPU();
+    if (cpu == currentCPU) {
+        return false;
+    }
+
+    DEBUG('t', "CPU %u goes idle\n", currentCPU);
+    keepSpace = false;
+    Descheduled(currentThread);
+    interrupt->StopCPU(currentCPU);
+    SwitchCPU(cpu, cpuThread[cpu]);
+    Resume();
+    return true;
+}
+
 /// Print the scheduler state -- in other words, the contents of the ready
 /// list.
 ///
@@ -152,15 +626,90 @@ void
 Scheduler::Print()
 {
     printf("Ready queue contents:\n");
-    for(int i = numberOfPriorities; i > 0; i--)
-    	readyMultiQueue[i-1]->Apply(ThreadPrint);
+    for (unsigned i = 0; i < strideSize; i++)
+        ThreadPrint(strideHeap[i]);
+    for (unsigned cpu = 0; cpu < numCPUs; cpu++)
+        for(int i = numberOfPriorities; i > 0; i--)
+            for (Thread *t = QueuesOf(cpu)[i-1].head; t != nullptr;
+                 t = t->readyNext)
+                ThreadPrint(t);
 }
 
+/// Change the priority of `thread`, moving it to the queue of its new
+/// priority if it is ready.  A running or blocked thread is only queued
+/// again when it becomes ready, so it is not touched.
 void
 Scheduler::UpdateReadyMultiQueue(Thread *thread, int newPriority)
 {
-    const int oldPriority = thread->GetPriority();
-    readyMultiQueue[oldPriority]->Remove(thread);
-    readyMultiQueue[newPriority]->Append(thread);
-    thread->ChangePriority(newPriority);
+    ASSERT(thread != nullptr);
+    ASSERT(newPriority >= 0 && newPriority < numberOfPriorities);
+
+    if (thread->GetStatus() == READY && policy != STRIDE_SCHEDULING) {
+        Dequeue(thread, QueueOf(thread));
+        thread->ChangePriority(newPriority);
+        Enqueue(thread, QueueOf(thread));
+    } else {
+        thread->ChangePriority(newPriority);
+    }
+}
+
+/// With MLFQ, threads that block go up a level: they are likely waiting for
+/// I/O, and should get the CPU quickly once it is done.
+void
+Scheduler::ThreadBlocked(Thread *thread)
+{
+    ASSERT(thread != nullptr);
+
+    if (policy == MLFQ_SCHEDULING) {
+        SetMlfqLevel(thread, MlfqLevel(thread) + 1);
+    }
+}
+
+void
+Scheduler::ThreadFinished(Thread *thread)
+{
+    ASSERT(thread != nullptr);
+
+    if (reportResponse) {
+        unsigned long now = stats->totalTicks;
+        printf("Thread \"%s\": %u dispatches, response time average %lu,"
+               " max %lu ticks\n", thread->GetName(), thread->dispatches,
+               thread->dispatches == 0 ? 0
+                                       : thread->totalWait / thread->dispatches,
+               thread->maxWait);
+        printf("    ran %lu ticks, finished at tick %lu\n",
+               thread->cpuTicks + now - thread->dispatchedAt, now);
+    }
+}
+
+void
+Scheduler::ReportResponseTimes(bool report)
+{
+    reportResponse = report;
+}
+
+void
+Scheduler::SetQuantum(int p, unsigned n)
+{
+    ASSERT(p >= 0 && p < numberOfPriorities);
+    ASSERT(n > 0);
+
+    quantum[p] = n;
+}
+
+void
+Scheduler::StartSlice(Thread *thread)
+{
+    thread->sliceTicks = 0;
+    thread->sliceExpired = false;
+}
+
+bool
+Scheduler::SliceExpired()
+{
+    Thread *thread = currentThread;
+    if (++thread->sliceTicks >= quantum[QueueOf(thread)]) {
+        thread->sliceExpired = true;
+    }
+    return thread->sliceExpired;
 }
@@ -12,17 +12,50 @@
 
 
 #include "thread.hh"
-#include "lib/list.hh"
 
 
+/// How the scheduler chooses the next thread to run.
+enum SchedulingPolicy {
+    /// Highest static priority first, with priority inheritance from locks.
+    PRIORITY_SCHEDULING,
+
+    /// Multi-level feedback queue: threads start at the top level, go down
+    /// a level every time they use up a whole time slice and up a level
+    /// every time they block, and every `MLFQ_BOOST_TICKS` all of them are
+    /// moved back to the top, so that none starves.  Static priorities are
+    /// ignored, except that a thread that inherited a priority from a lock
+    /// is queued at least at that level.
+    MLFQ_SCHEDULING,
+
+    /// Stride scheduling: every thread gets a share of the CPU proportional
+    /// to its weight (see `Thread::SetWeight`).  The thread that runs next
+    /// is the one with the lowest pass, kept in a binary heap.
+    STRIDE_SCHEDULING
+};
+
+/// Ticks between two boosts of every thread to the top MLFQ level.
+const unsigned long MLFQ_BOOST_TICKS = 5000;
+
+/// Pass a thread of weight 1 advances per tick under stride scheduling.
+const unsigned long STRIDE1 = 1 << 20;
+
 /// The following class defines the scheduler/dispatcher abstraction --
 /// the data structures and operations needed to keep track of which
 /// thread is running, and which threads are ready but not running.
 class Scheduler {
 public:
 
+    static const int MAX_PRIORITIES = 32;
+    static const int DEFAULT_PRIORITIES = 10;
+
     /// Initialize multiqueue of ready threads.
-    Scheduler(int priorities = 10);
+    ///
+    /// There can be at most `MAX_PRIORITIES` priorities.  With more than
+    /// one CPU, each of them gets a multiqueue of its own (except under
+    /// stride scheduling, where they all share the heap of ready threads).
+    Scheduler(int priorities = DEFAULT_PRIORITIES,
+              SchedulingPolicy policy = PRIORITY_SCHEDULING,
+              unsigned cpus = 1);
 
     /// De-allocate ready multiqueue.
     ~Scheduler();
@@ -31,7 +64,11 @@ public:
     void ReadyToRun(Thread *thread);
 
     /// Dequeue first thread on the ready queue in the multiqueue, if any, and return thread.
-    Thread *FindNextToRun();
+    ///
+    /// If the running thread is looking for another one to give the CPU
+    /// to, it passes itself as `yielding`; policies that do not always
+    /// switch may then return null, meaning it should keep running.
+    Thread *FindNextToRun(Thread *yielding = nullptr);
 
     /// Cause `nextThread` to start running.
     void Run(Thread *nextThread);
@@ -42,11 +79,143 @@ public:
     // Update the 'thread' priority and the multiqueue.
     void UpdateReadyMultiQueue(Thread *thread, int newPriority);
 
+    /// The running `thread` is about to block.
+    void ThreadBlocked(Thread *thread);
+
+    /// The running `thread` is finishing.
+    void ThreadFinished(Thread *thread);
+
+    /// Print the response times of every thread when it finishes.
+    void ReportResponseTimes(bool report);
+
+    /// Set the time slice of threads of priority (or MLFQ level) `p` to
+    /// `n` timer interrupts.  By default it is 1 for every priority.
+    void SetQuantum(int p, unsigned n);
+
+    /// Called on every timer interrupt: count it in the time slice of the
+    /// running thread, and return whether the slice is over.
+    bool SliceExpired();
+
+    /// Called by the machine when the running CPU has had its turn: give
+    /// an idle CPU with work its first turn, or else let the running CPU
+    /// that is furthest behind have one.
+    void Interleave();
+
+    /// Called by a thread that is about to block, when its CPU has nothing
+    /// else to run.  If other CPUs are running, leave this one idle and go
+    /// on with them; return true once the thread has been dispatched again.
+    /// Return false if there are no other running CPUs, so the machine has
+    /// to wait for an interrupt.
+    bool LeaveCPU();
+
 private:
 
-    // MultiQueue of threads that are ready to run, but not running.
-    List<Thread*>** readyMultiQueue;
+    /// A queue of ready threads, linked through `Thread::readyNext` and
+    /// `Thread::readyPrev`.
+    struct ReadyQueue {
+        Thread *head;
+        Thread *tail;
+    };
+
+    /// Add `thread` to, or remove it from, the queue of priority `p` of
+    /// the CPU it belongs to (`thread->cpu`).
+    void Enqueue(Thread *thread, int p);
+    void Dequeue(Thread *thread, int p);
+
+    /// The multiqueue of CPU `cpu`.
+    ReadyQueue *QueuesOf(unsigned cpu) const;
+
+    /// Take the next thread for CPU `cpu` out of the ready threads, if any.
+    Thread *TakeReady(unsigned cpu);
+
+    /// Take a thread for CPU `cpu` from the CPU with most ready threads.
+    Thread *Steal(unsigned cpu);
+
+    /// CPU where a new thread is made ready for the first time.
+    unsigned LeastLoadedCPU() const;
+
+    /// The running CPU, other than the current one, furthest behind; the
+    /// current one if there is none.
+    unsigned EarliestCPU() const;
+
+    /// Bookkeeping for `thread` leaving, and getting, the CPU.
+    void Descheduled(Thread *thread);
+    void Dispatch(Thread *thread, unsigned cpu);
+
+    /// Go on running `nextThread` on CPU `cpu`.
+    void SwitchCPU(unsigned cpu, Thread *nextThread);
+
+    /// Tidy up after a thread gets the CPU back from `Run` or `LeaveCPU`.
+    void Resume();
+
+    /// Queue where `thread` goes when it is ready.
+    int QueueOf(Thread *thread) const;
+
+    /// Give `thread` a new time slice.
+    void StartSlice(Thread *thread);
+
+    /// Time slice of each priority, in timer interrupts.
+    unsigned *quantum;
+
+    int MlfqLevel(Thread *thread) const;
+    void SetMlfqLevel(Thread *thread, int level);
+
+    /// Move every ready thread to the top MLFQ level.
+    void Boost();
+
+    /// Add the time `thread` has been running to its pass.
+    void ChargePass(Thread *thread);
+
+    void HeapPush(Thread *thread);
+    Thread *HeapPop();
+
+    SchedulingPolicy policy;
+
+    // MultiQueue of threads that are ready to run, but not running, one
+    // queue per priority and CPU.
+    ReadyQueue *readyMultiQueue;
     int numberOfPriorities;
+
+    /// For each CPU, bit `p` is set when its queue of priority `p` is not
+    /// empty, so that the highest priority with ready threads is found in
+    /// one step.
+    unsigned *readyLevels;
+
+    /// Number of ready threads in the multiqueue of each CPU.
+    unsigned *readyCount;
+
+    unsigned numCPUs;
+    unsigned currentCPU;  ///< The CPU `currentThread` runs on.
+
+    /// Thread each CPU other than the current one is running, or null if
+    /// it is idle.
+    Thread **cpuThread;
+
+    /// MLFQ levels of the threads are only valid within an epoch; a boost
+    /// starts a new one.
+    unsigned mlfqEpoch;
+    unsigned long nextBoost;
+
+    /// Ready threads under stride scheduling, a binary heap ordered by
+    /// pass.
+    Thread **strideHeap;
+    unsigned strideSize;
+    unsigned strideCapacity;
+
+    /// Pass of the last thread dispatched: threads that were not ready
+    /// start from here, so that sleeping does not earn them CPU time.
+    unsigned long globalPass;
+
+    bool reportResponse;
+
+    /// Whether the thread `Run` is switching to has the address space of
+    /// the one leaving, so that neither `AddressSpace::SaveState` nor
+    /// `AddressSpace::RestoreState` needs to be called.
+    bool keepSpace;
+
+    /// Host time the switch in progress started at, when measuring how
+    /// long switches take (`-ips`); 0 otherwise.
+    double switchStart;
 };
 
 
@@ -0,0 +1,120 @@
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+
+#include "stack_pool.hh"
+#include "lib/utility.hh"
+#include "machine/system_dep.hh"
+
+#include <stdio.h>
+
+
+StackPool::StackPool(unsigned limit_)
+{
+    for (unsigned c = 0; c < NUM_STACK_CLASSES; c++) {
+        freeStacks[c] = nullptr;
+        numFree[c] = 0;
+    }
+    limit = limit_;
+    reused = allocated = released = 0;
+}
+
+StackPool::~StackPool()
+{
+    SetLimit(0);
+}
+
+unsigned
+StackPool::ClassOf(unsigned size)
+{
+    unsigned c = 0;
+    while (c < NUM_STACK_CLASSES && MIN_STACK_SIZE << c < size) {
+        c++;
+    }
+    return c;
+}
+
+uintptr_t *
+StackPool::Allocate(unsigned size)
+{
+    return (uintptr_t *)
+             SystemDep::AllocBoundedArray(size * sizeof (uintptr_t));
+}
+
+void
+StackPool::Deallocate(uintptr_t *stack, unsigned size)
+{
+    SystemDep::DeallocBoundedArray((char *) stack,
+                                   size * sizeof (uintptr_t));
+}
+
+uintptr_t *
+StackPool::Get(unsigned *size)
+{
+    ASSERT(size != nullptr);
+    ASSERT(*size > 0);
+
+    unsigned c = ClassOf(*size);
+    if (c < NUM_STACK_CLASSES) {
+        *size = MIN_STACK_SIZE << c;
+        if (freeStacks[c] != nullptr) {
+            uintptr_t *stack = freeStacks[c];
+            freeStacks[c] = (uintptr_t *) *stack;
+            numFree[c]--;
+            reused++;
+            return stack;
+        }
+    }
+    allocated++;
+    return Allocate(*size);
+}
+
+void
+StackPool::Put(uintptr_t *stack, unsigned size)
+{
+    ASSERT(stack != nullptr);
+
+    unsigned c = ClassOf(size);
+    if (c < NUM_STACK_CLASSES && numFree[c] < limit) {
+        ASSERT(size == MIN_STACK_SIZE << c);
+        *stack = (uintptr_t) freeStacks[c];
+        freeStacks[c] = stack;
+        numFree[c]++;
+        return;
+    }
+    released++;
+    Deallocate(stack, size);
+}
+
+void
+StackPool::SetLimit(unsigned newLimit)
+{
+    limit = newLimit;
+    for (unsigned c = 0; c < NUM_STACK_CLASSES; c++) {
+        while (numFree[c] > limit) {
+            uintptr_t *stack = freeStacks[c];
+            freeStacks[c] = (uintptr_t *) *stack;
+            numFree[c]--;
+            released++;
+            Deallocate(stack, MIN_STACK_SIZE << c);
+        }
+    }
+}
+
+unsigned
+StackPool::GetLimit() const
+{
+    return limit;
+}
+
+void
+StackPool::Print() const
+{
+    unsigned cached = 0;
+    for (unsigned c = 0; c < NUM_STACK_CLASSES; c++) {
+        cached += numFree[c];
+    }
+    printf("Stacks: %lu reused, %lu allocated, %lu released, %u cached\n",
+           reused, allocated, released, cached);
+}
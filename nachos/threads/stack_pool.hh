@@ -0,0 +1,81 @@
+/// Pool of thread execution stacks.
+///
+/// Allocating a stack takes a bounded array from the host (with a guard
+/// page at each end), and finishing a thread used to give it back, so that
+/// every short-lived thread paid for both.  Instead, finished threads leave
+/// their stacks here, and `Thread::Fork` takes one of the right size if
+/// there is any.
+///
+/// Stacks come in size classes: powers of two times `MIN_STACK_SIZE` words,
+/// up to `MAX_POOLED_STACK_SIZE`.  A request is rounded up to its class;
+/// bigger stacks are allocated with their exact size and never kept.
+/// Stacks in the pool stay allocated, so their guard pages are not touched.
+///
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+#ifndef NACHOS_THREADS_STACKPOOL__HH
+#define NACHOS_THREADS_STACKPOOL__HH
+
+
+#include <stdint.h>
+
+
+/// Size of the smallest stack class, in words.
+const unsigned MIN_STACK_SIZE = 1024;
+
+/// Number of stack classes; the biggest is `MAX_POOLED_STACK_SIZE` words.
+const unsigned NUM_STACK_CLASSES = 6;
+const unsigned MAX_POOLED_STACK_SIZE
+  = MIN_STACK_SIZE << (NUM_STACK_CLASSES - 1);
+
+/// Stacks kept for reuse in each class, unless told otherwise with `-sp`.
+const unsigned DEFAULT_POOLED_STACKS = 32;
+
+class StackPool {
+public:
+
+    /// Keep up to `limit` free stacks of each class; 0 keeps none.
+    StackPool(unsigned limit = DEFAULT_POOLED_STACKS);
+
+    /// Give every free stack back to the host.
+    ~StackPool();
+
+    /// Get a stack of at least `*size` words, and set `*size` to the size
+    /// it actually has.
+    uintptr_t *Get(unsigned *size);
+
+    /// Take back a stack obtained from `Get`, of `size` words as `Get` set
+    /// it.
+    void Put(uintptr_t *stack, unsigned size);
+
+    /// Change how many free stacks are kept in each class, giving back
+    /// those over the new limit.
+    void SetLimit(unsigned newLimit);
+    unsigned GetLimit() const;
+
+    void Print() const;
+
+private:
+
+    /// Class of stacks of `size` words, or `NUM_STACK_CLASSES` if they are
+    /// too big to be pooled.
+    static unsigned ClassOf(unsigned size);
+
+    static uintptr_t *Allocate(unsigned size);
+    static void Deallocate(uintptr_t *stack, unsigned size);
+
+    /// Free stacks of each class, linked through their first word.
+    uintptr_t *freeStacks[NUM_STACK_CLASSES];
+    unsigned numFree[NUM_STACK_CLASSES];
+
+    unsigned limit;
+
+    unsigned long reused;     ///< Stacks taken from the pool.
+    unsigned long allocated;  ///< Stacks taken from the host.
+    unsigned long released;   ///< Stacks given back to the host.
+};
+
+
+#endif
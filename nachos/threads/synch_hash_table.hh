@@ -0,0 +1,127 @@
+/// Data structures for synchronized access to a hash table.
+///
+/// Implemented by surrounding the `HashTable` abstraction with a lock.
+///
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+#ifndef NACHOS_THREADS_SYNCHHASHTABLE__HH
+#define NACHOS_THREADS_SYNCHHASHTABLE__HH
+
+
+#include "lock.hh"
+#include "lib/hash_table.hh"
+
+
+/// A `HashTable` that one thread at a time can access.
+///
+/// It takes the place of the keyed operations of `SynchList`, which look
+/// for a key through the whole list.
+template <class Item>
+class SynchHashTable {
+public:
+
+    /// Initialize a synchronized hash table, empty.
+    SynchHashTable();
+
+    /// De-allocate a synchronized hash table.
+    ~SynchHashTable();
+
+    /// Associate `item` with `key`, which must not have an item yet.
+    void Add(int key, Item item);
+
+    /// Get the item associated with `key`, or `Item()` if there is none.
+    Item Get(int key);
+
+    /// Associate `item` with `key`, unless `key` has an item already.
+    ///
+    /// Returns the item associated with `key` now, so that threads that
+    /// each made an item for the same key all end up with the same one.
+    Item GetOrAdd(int key, Item item);
+
+    /// Does the table have some item for `key`?
+    bool HasKey(int key);
+
+    /// Remove the item associated with `key`, and return it.
+    Item Remove(int key);
+
+private:
+
+    // The unsynchronized table.
+    HashTable<Item> *table;
+
+    // Enforce mutual exclusive access to the table.
+    Lock *lock;
+
+};
+
+template <class Item>
+SynchHashTable<Item>::SynchHashTable()
+{
+    table = new HashTable<Item>;
+    lock  = new Lock("hash table lock");
+}
+
+template <class Item>
+SynchHashTable<Item>::~SynchHashTable()
+{
+    delete table;
+    delete lock;
+}
+
+template <class Item>
+void
+SynchHashTable<Item>::Add(int key, Item item)
+{
+    lock->Acquire();
+    table->Add(key, item);
+    lock->Release();
+}
+
+template <class Item>
+Item
+SynchHashTable<Item>::Get(int key)
+{
+    lock->Acquire();
+    Item item = table->Get(key);
+    lock->Release();
+    return item;
+}
+
+template <class Item>
+Item
+SynchHashTable<Item>::GetOrAdd(int key, Item item)
+{
+    lock->Acquire();
+    if (table->HasKey(key)) {
+        item = table->Get(key);
+    } else {
+        table->Add(key, item);
+    }
+    lock->Release();
+    return item;
+}
+
+template <class Item>
+bool
+SynchHashTable<Item>::HasKey(int key)
+{
+    lock->Acquire();
+    bool has = table->HasKey(key);
+    lock->Release();
+    return has;
+}
+
+template <class Item>
+Item
+SynchHashTable<Item>::Remove(int key)
+{
+    lock->Acquire();
+    Item item = table->Remove(key);
+    lock->Release();
+    return item;
+}
+
+
+#endif
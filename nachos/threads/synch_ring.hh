@@ -0,0 +1,172 @@
+/// Data structures for synchronized access to a bounded queue.
+///
+/// Like `SynchList`, but items are kept in a ring buffer of fixed capacity
+/// allocated once, instead of a linked list that allocates an element for
+/// every item appended.
+///
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+#ifndef NACHOS_THREADS_SYNCHRING__HH
+#define NACHOS_THREADS_SYNCHRING__HH
+
+
+#include "condition.hh"
+
+
+/// The following class defines a "synchronized ring" -- a queue of at most
+/// `capacity` items for which these constraints hold:
+///
+/// 1. Threads trying to remove an item wait until the queue has one.
+/// 2. Threads trying to append an item wait until the queue has room.
+/// 3. One thread at a time can access the queue.
+///
+/// `AppendMany` and `RemoveMany` move several items while holding the lock
+/// once, and wake up waiting threads once for all of them.
+template <class Item>
+class SynchRing {
+public:
+
+    /// Initialize a synchronized ring, empty, with room for `capacity`
+    /// items.
+    SynchRing(unsigned capacity);
+
+    /// De-allocate a synchronized ring.
+    ~SynchRing();
+
+    unsigned GetCapacity() const;
+
+    /// Append `item` at the end, waiting while the ring is full, and wake up
+    /// a thread waiting in remove.
+    void Append(Item item);
+
+    /// Remove the first item, waiting while the ring is empty.
+    Item Pop();
+
+    /// Append the `count` items in `items`, in order, waiting whenever the
+    /// ring is full.
+    void AppendMany(const Item *items, unsigned count);
+
+    /// Remove up to `max` items into `items`, waiting only while the ring
+    /// is empty.
+    ///
+    /// Returns how many items were removed, at least 1.
+    unsigned RemoveMany(Item *items, unsigned max);
+
+private:
+
+    /// The items, `count` of them starting at `first`.
+    Item *ring;
+    unsigned capacity;
+    unsigned first;
+    unsigned count;
+
+    // Enforce mutual exclusive access to the ring.
+    Lock *lock;
+
+    // Wait in `Pop` if the ring is empty, and in `Append` if it is full.
+    Condition *ringEmpty;
+    Condition *ringFull;
+
+};
+
+template <class Item>
+SynchRing<Item>::SynchRing(unsigned capacity_)
+{
+    ASSERT(capacity_ > 0);
+
+    capacity  = capacity_;
+    ring      = new Item [capacity];
+    first     = count = 0;
+    lock      = new Lock("ring lock");
+    ringEmpty = new Condition("ring empty cond", lock);
+    ringFull  = new Condition("ring full cond", lock);
+}
+
+template <class Item>
+SynchRing<Item>::~SynchRing()
+{
+    delete [] ring;
+    delete lock;
+    delete ringEmpty;
+    delete ringFull;
+}
+
+template <class Item>
+unsigned
+SynchRing<Item>::GetCapacity() const
+{
+    return capacity;
+}
+
+template <class Item>
+void
+SynchRing<Item>::Append(Item item)
+{
+    AppendMany(&item, 1);
+}
+
+template <class Item>
+Item
+SynchRing<Item>::Pop()
+{
+    Item item;
+    RemoveMany(&item, 1);
+    return item;
+}
+
+template <class Item>
+void
+SynchRing<Item>::AppendMany(const Item *items, unsigned n)
+{
+    ASSERT(items != nullptr);
+
+    lock->Acquire();
+    unsigned appended = 0;
+    while (appended < n) {
+        while (count == capacity) {
+            ringFull->Wait();
+        }
+        unsigned batch = 0;
+        for (; appended < n && count < capacity; appended++, batch++) {
+            ring[(first + count) % capacity] = items[appended];
+            count++;
+        }
+        if (batch == 1) {
+            ringEmpty->Signal();     // Wake up a waiter, if any.
+        } else {
+            ringEmpty->Broadcast();  // There may be something for each.
+        }
+    }
+    lock->Release();
+}
+
+template <class Item>
+unsigned
+SynchRing<Item>::RemoveMany(Item *items, unsigned max)
+{
+    ASSERT(items != nullptr);
+    ASSERT(max > 0);
+
+    lock->Acquire();
+    while (count == 0) {
+        ringEmpty->Wait();
+    }
+    unsigned n = 0;
+    for (; n < max && count > 0; n++) {
+        items[n] = ring[first];
+        first = (first + 1) % capacity;
+        count--;
+    }
+    if (n == 1) {
+        ringFull->Signal();
+    } else {
+        ringFull->Broadcast();
+    }
+    lock->Release();
+    return n;
+}
+
+
+#endif
@@ -52,8 +52,10 @@ General:\n\
       PROGRAM, VERSION, OPTIONS);
 
 unsigned num_pages = DEFAULT_NUM_PHYS_PAGES;
+unsigned tlb_size = DEFAULT_TLB_SIZE;
 #ifdef USER_PROGRAM
       num_pages = machine->GetNumPhysicalPages();
+      tlb_size = machine->GetMMU()->GetTLBSize();
 #endif    
 
     printf("\n\
@@ -61,7 +63,7 @@ Memory:\n\
   Page size: %d bytes.\n\
   Number of pages: %d.\n\
   Number of TLB entries: %d.\n\
-  Memory size: %d bytes.\n", PAGE_SIZE, num_pages, TLB_SIZE, num_pages * PAGE_SIZE);
+  Memory size: %d bytes.\n", PAGE_SIZE, num_pages, tlb_size, num_pages * PAGE_SIZE);
 
 #include"../machine/disk.hh"
     printf("\n\
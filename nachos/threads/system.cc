@@ -10,8 +10,13 @@
 #ifdef USER_PROGRAM
 #include "userprog/debugger.hh"
 #include "userprog/exception.hh"
+#include "userprog/page_policy.hh"
+#include "userprog/tlb_policy.hh"
 #include "lib/coremap.hh"
 #endif
+#ifdef FILESYS
+#include "rw_lock.hh"
+#endif
 
 #include <stdlib.h>
 #include <string.h>
@@ -26,6 +31,7 @@ Thread *threadToBeDestroyed;  ///< The thread that just finished.
 Scheduler *scheduler;         ///< The ready list.
 Interrupt *interrupt;         ///< Interrupt status.
 Statistics *stats;            ///< Performance metrics.
+StackPool *stackPool;         ///< Stacks of finished threads, for reuse.
 Timer *timer;                 ///< The hardware timer device, for invoking
                               ///< context switches.
 
@@ -36,9 +42,9 @@ FileSystem *fileSystem;
 
 #ifdef FILESYS
 SynchDisk *synchDisk;
-Lock **locksSector;
+RWLock **locksSector;
 Lock *lockFS;
-SynchList<FileHeader *> *openFileList;
+SynchHashTable<FileHeader *> *openFileList;
 #endif
 
 #ifdef USER_PROGRAM  // Requires either *FILESYS* or *FILESYS_STUB*.
@@ -46,6 +52,10 @@ SynchConsole *synchConsole;
 Machine *machine;  ///< User program memory and registers.
 Coremap *memoryPages;
 Table<Thread *> *processesTable;
+TLBPolicy **tlbPolicies;
+PagePolicy *pagePolicy;
+Thread *batchThread;
+int exitStatus;
 #endif
 
 
@@ -53,6 +63,10 @@ Table<Thread *> *processesTable;
 // External definition, to allow us to take a pointer to this function.
 extern void Cleanup();
 
+/// Number of locks to report on when halting (`-lp`), if any.
+static const unsigned LOCK_REPORT_SIZE = 10;
+static bool lockReport = false;
+
 /// Interrupt handler for the timer device.
 ///
 /// The timer device is set up to interrupt the CPU periodically (once every
@@ -70,7 +84,12 @@ extern void Cleanup();
 static void
 TimerInterruptHandler(void *dummy)
 {
-    if (interrupt->GetStatus() != IDLE_MODE) {
+#ifdef USER_PROGRAM
+    if (pagePolicy != nullptr) {
+        pagePolicy->Sample();
+    }
+#endif
+    if (interrupt->GetStatus() != IDLE_MODE && scheduler->SliceExpired()) {
         interrupt->YieldOnReturn();
     }
 }
@@ -129,10 +148,27 @@ Initialize(int argc, char **argv)
     const char *debugFlags = "";
     DebugOpts debugOpts;
     bool randomYield = false;
+    SchedulingPolicy policy = PRIORITY_SCHEDULING;
+    bool reportResponse = false;  // Print response times of threads.
+    unsigned long quantum = 0;  // Ticks between timer interrupts, if fixed.
+    unsigned quanta[Scheduler::MAX_PRIORITIES] = {};
+      // Time slice of each priority, in timer interrupts; 0 for default.
+    unsigned numCPUs = 1;
+    unsigned pooledStacks = DEFAULT_POOLED_STACKS;
 
 #ifdef USER_PROGRAM
     bool debugUserProg = false;  // Single step user program.
+    bool useBlocks = false;  // Run user programs a basic block at a time.
+    bool reportSpeed = false;  // Print user instructions per host second.
     int numPhysicalPages = DEFAULT_NUM_PHYS_PAGES;
+    unsigned tlbSize = DEFAULT_TLB_SIZE;
+    unsigned tlbWays = 0;  // Fully associative.
+    const char *tlbPolicyName = "fifo";
+#ifdef VMEM
+    const char *pagePolicyName = "clock";
+#else
+    const char *pagePolicyName = "random";
+#endif
 #endif
 #ifdef FILESYS_NEEDED
     bool format = false;  // Format disk.
@@ -161,16 +197,82 @@ Initialize(int argc, char **argv)
               // Initialize pseudo-random number generator.
             randomYield = true;
             argCount = 2;
+        } else if (!strcmp(*argv, "-sched")) {
+            ASSERT(argc > 1);
+            if (!strcmp(*(argv + 1), "priority")) {
+                policy = PRIORITY_SCHEDULING;
+            } else if (!strcmp(*(argv + 1), "mlfq")) {
+                policy = MLFQ_SCHEDULING;
+            } else if (!strcmp(*(argv + 1), "stride")) {
+                policy = STRIDE_SCHEDULING;
+            } else {
+                ASSERT(false);  // Unknown policy.
+            }
+            argCount = 2;
+        } else if (!strcmp(*argv, "-rt")) {
+            reportResponse = true;
+        } else if (!strcmp(*argv, "-q")) {
+            ASSERT(argc > 1);
+            quantum = atoi(*(argv + 1));
+            ASSERT(quantum > 0);
+            argCount = 2;
+        } else if (!strcmp(*argv, "-qp")) {
+            ASSERT(argc > 2);
+            int p = atoi(*(argv + 1));
+            int n = atoi(*(argv + 2));
+            // The scheduler is made with the default number of priorities.
+            ASSERT(p >= 0 && p < Scheduler::DEFAULT_PRIORITIES && n > 0);
+            quanta[p] = n;
+            argCount = 3;
+        } else if (!strcmp(*argv, "-lp")) {
+            lockReport = true;
+        } else if (!strcmp(*argv, "-sp")) {
+            ASSERT(argc > 1);
+            pooledStacks = atoi(*(argv + 1));
+            argCount = 2;
         }
 #ifdef USER_PROGRAM
         if (!strcmp(*argv, "-s")) {
             debugUserProg = true;
         }
+        if (!strcmp(*argv, "-bb")) {
+            useBlocks = true;
+        }
+        if (!strcmp(*argv, "-ips")) {
+            reportSpeed = true;
+        }
         if (!strcmp(*argv, "-m")) {
             ASSERT(argc > 1);
             numPhysicalPages = atoi(*(argv + 1));
             argCount = 2;
         }
+        if (!strcmp(*argv, "-tlb")) {
+            ASSERT(argc > 1);
+            tlbSize = atoi(*(argv + 1));
+            ASSERT(tlbSize > 0);
+            argCount = 2;
+        }
+        if (!strcmp(*argv, "-tlbw")) {
+            ASSERT(argc > 1);
+            tlbWays = atoi(*(argv + 1));
+            argCount = 2;
+        }
+        if (!strcmp(*argv, "-tlbp")) {
+            ASSERT(argc > 1);
+            tlbPolicyName = *(argv + 1);
+            argCount = 2;
+        }
+        if (!strcmp(*argv, "-prp")) {
+            ASSERT(argc > 1);
+            pagePolicyName = *(argv + 1);
+            argCount = 2;
+        }
+        if (!strcmp(*argv, "-cpus")) {
+            ASSERT(argc > 1);
+            numCPUs = atoi(*(argv + 1));
+            ASSERT(numCPUs > 0);
+            argCount = 2;
+        }
 #endif
 #ifdef FILESYS_NEEDED
         if (!strcmp(*argv, "-f")) {
@@ -189,12 +291,34 @@ Initialize(int argc, char **argv)
     debug.SetOpts(debugOpts);    // Set debugging behavior.
     stats = new Statistics;      // Collect statistics.
     interrupt = new Interrupt;   // Start up interrupt handling.
-    scheduler = new Scheduler;   // Initialize the ready queue.
-    if (randomYield) {           // Start the timer (if needed).
+    interrupt->SetCPUs(numCPUs);
+    scheduler = new Scheduler(Scheduler::DEFAULT_PRIORITIES, policy,
+                              numCPUs);
+                                 // Initialize the ready queue.
+    scheduler->ReportResponseTimes(reportResponse);
+    bool slicing = quantum != 0 || randomYield
+                     || policy != PRIORITY_SCHEDULING;
+    for (int p = 0; p < Scheduler::DEFAULT_PRIORITIES; p++) {
+        if (quanta[p] != 0) {
+            // Time slices are counted in timer interrupts: without a timer
+            // they would never end.
+            ASSERT(slicing);
+            scheduler->SetQuantum(p, quanta[p]);
+        }
+    }
+    if (quantum != 0) {          // Start the timer (if needed).  A fixed
+                                 // quantum preempts deterministically,
+                                 // unless `-rs` asks for random slices of
+                                 // that length on average.
+        timer = new Timer(TimerInterruptHandler, 0, randomYield, quantum);
+    } else if (randomYield || policy != PRIORITY_SCHEDULING) {
+                                 // MLFQ and stride scheduling need time
+                                 // slices.
         timer = new Timer(TimerInterruptHandler, 0, randomYield);
     }
 
     threadToBeDestroyed = nullptr;
+    stackPool = new StackPool(pooledStacks);
 
     // We did not explicitly allocate the current thread we are running in.
     // But if it ever tries to give up the CPU, we better have a `Thread`
@@ -206,20 +330,31 @@ Initialize(int argc, char **argv)
     SystemDep::CallOnUserAbort(Cleanup);  // If user hits ctl-C...
 
 #ifdef USER_PROGRAM
+    stats->reportSpeed = reportSpeed;
     Debugger *d = debugUserProg ? new Debugger : nullptr;
-    machine = new Machine(d, numPhysicalPages);  // This must come first.
+    ASSERT(tlbWays == 0 || tlbSize % tlbWays == 0);
+    machine = new Machine(d, numPhysicalPages, useBlocks, tlbSize, tlbWays,
+                          numCPUs);
+      // This must come first.
+    tlbPolicies = new TLBPolicy *[numCPUs];
+    for (unsigned i = 0; i < numCPUs; i++) {
+        tlbPolicies[i] = TLBPolicy::Create(tlbPolicyName, tlbSize);
+        ASSERT(tlbPolicies[i] != nullptr);
+    }
     synchConsole = new SynchConsole();
     memoryPages = new Coremap(numPhysicalPages);
+    pagePolicy = PagePolicy::Create(pagePolicyName, numPhysicalPages);
+    ASSERT(pagePolicy != nullptr);
     SetExceptionHandlers();
-    processesTable = new Table<Thread *>();
+    processesTable = new Table<Thread *>(true);
 #endif
 
 #ifdef FILESYS
     synchDisk = new SynchDisk("DISK");
     lockFS = new Lock("File System lock");
-    locksSector = new Lock* [NUM_SECTORS];
+    locksSector = new RWLock* [NUM_SECTORS];
     for(unsigned int i = 0; i < NUM_SECTORS; i++) locksSector[i] = nullptr;
-    openFileList = new SynchList<FileHeader *>();
+    openFileList = new SynchHashTable<FileHeader *>();
 #endif
 
 #ifdef FILESYS_NEEDED
@@ -237,7 +372,16 @@ Cleanup()
 {
     DEBUG('i', "Cleaning up...\n");
 
+    if (lockReport) {
+        LockProfile::PrintHottest(LOCK_REPORT_SIZE);
+    }
+
 #ifdef USER_PROGRAM
+    for (unsigned i = 0; i < machine->GetNumCPUs(); i++) {
+        delete tlbPolicies[i];
+    }
+    delete [] tlbPolicies;
+    delete pagePolicy;
     delete machine;
 #endif
 
@@ -265,6 +409,11 @@ Cleanup()
     Thread *t = currentThread;
     currentThread = NULL;
     delete t;
+    delete stackPool;
 
+#ifdef USER_PROGRAM
+    exit(exitStatus);
+#else
     exit(0);
+#endif
 }
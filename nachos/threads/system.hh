@@ -12,6 +12,7 @@
 #include "thread.hh"
 #include "synch_list.hh"
 #include "scheduler.hh"
+#include "stack_pool.hh"
 #include "lib/utility.hh"
 #include "machine/interrupt.hh"
 #include "machine/statistics.hh"
@@ -33,6 +34,7 @@ extern Thread *threadToBeDestroyed;  ///< The thread that just finished.
 extern Scheduler *scheduler;         ///< The ready list.
 extern Interrupt *interrupt;         ///< Interrupt status.
 extern Statistics *stats;            ///< Performance metrics.
+extern StackPool *stackPool;         ///< Stacks of finished threads.
 extern Timer *timer;                 ///< The hardware alarm clock.
 
 #ifdef USER_PROGRAM
@@ -40,6 +42,15 @@ extern Timer *timer;                 ///< The hardware alarm clock.
 extern Machine *machine;  // User program memory and registers.
 extern SynchConsole *synchConsole;
 extern Table<Thread *> *processesTable;
+class TLBPolicy;
+extern TLBPolicy **tlbPolicies;  // Replacement policy of the TLB of each
+                                 // CPU, if there is a TLB.
+class PagePolicy;
+extern PagePolicy *pagePolicy;  // Page replacement policy.
+extern Thread *batchThread;  // In an instance of a batch (see `StartBatch`),
+                             // the thread running its user program.
+extern int exitStatus;       // What Nachos exits with: the status of
+                             // `batchThread`, if any, or 0.
 #endif
 
 #ifdef FILESYS_NEEDED  // *FILESYS* or *FILESYS_STUB*.
@@ -49,7 +60,8 @@ extern FileSystem *fileSystem;
 
 #ifdef FILESYS
 #include "filesys/synch_disk.hh"
-extern SynchList<FileHeader *> *openFileList;
+#include "synch_hash_table.hh"
+extern SynchHashTable<FileHeader *> *openFileList;
 extern SynchDisk *synchDisk;
 extern Lock *lockFS;   
 #endif
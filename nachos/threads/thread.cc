@@ -43,6 +43,7 @@ Thread::Thread(const char *threadName, bool willJoin, int prior)
     name     = threadName;
     stackTop = nullptr;
     stack    = nullptr;
+    stackSize = STACK_SIZE;
     status   = JUST_CREATED;
     if(willJoin){
         channel = new Channel("join channel");
@@ -50,6 +51,18 @@ Thread::Thread(const char *threadName, bool willJoin, int prior)
     else channel = nullptr;
 
     priority = originalPriority = prior;
+    readyNext = readyPrev = nullptr;
+    readySince = dispatchedAt = 0;
+    totalWait = maxWait = 0;
+    dispatches = 0;
+    cpuTicks = 0;
+    sliceTicks = 0;
+    sliceExpired = false;
+    mlfqLevel = 0;
+    mlfqEpoch = 0;  // Older than any epoch: starts at the top level.
+    weight = DEFAULT_WEIGHT;
+    pass = 0;
+    cpu = 0;
 #ifdef USER_PROGRAM
     childList = new List<Thread *>();
     space    = nullptr;
@@ -77,8 +90,7 @@ Thread::~Thread()
     processesTable->Remove(sid);
     #endif
     if (stack != nullptr) {
-        SystemDep::DeallocBoundedArray((char *) stack,
-                                       STACK_SIZE * sizeof *stack);
+        stackPool->Put(stack, stackSize);
     }
 }
 
@@ -154,6 +166,12 @@ Thread::SetStatus(ThreadStatus st)
     status = st;
 }
 
+ThreadStatus
+Thread::GetStatus() const
+{
+    return status;
+}
+
 const char *
 Thread::GetName() const
 {
@@ -181,6 +199,35 @@ Thread::GetPriority()
     return priority;
 }
 
+/// Make the stack of the thread at least `words` long, instead of
+/// `STACK_SIZE`.  Only before it is forked.
+void
+Thread::SetStackSize(unsigned words)
+{
+    ASSERT(stack == nullptr);
+    ASSERT(words > 0);
+    stackSize = words;
+}
+
+unsigned
+Thread::GetStackSize() const
+{
+    return stackSize;
+}
+
+void
+Thread::SetWeight(unsigned w)
+{
+    ASSERT(w > 0);
+    weight = w;
+}
+
+unsigned
+Thread::GetWeight() const
+{
+    return weight;
+}
+
 /// Returns the original prority of the process.
 int
 Thread::GetOriginalPriority()
@@ -206,6 +253,7 @@ Thread::Finish(int exitstatus)
 
     ASSERT(this == currentThread);
     DEBUG('t', "Finishing thread \"%s\"\n", GetName());
+    scheduler->ThreadFinished(this);
         #ifdef USER_PROGRAM
             delete currentThread->space;
             currentThread->space = nullptr;
@@ -246,7 +294,7 @@ Thread::Yield()
 
     DEBUG('t', "Yielding thread \"%s\"\n", GetName());
 
-    Thread *nextThread = scheduler->FindNextToRun();
+    Thread *nextThread = scheduler->FindNextToRun(this);
     if (nextThread != nullptr) {
         scheduler->ReadyToRun(this);
         scheduler->Run(nextThread);
@@ -279,7 +327,12 @@ Thread::Sleep()
 
     Thread *nextThread;
     status = BLOCKED;
+    scheduler->ThreadBlocked(this);
     while ((nextThread = scheduler->FindNextToRun()) == nullptr) {
+        if (scheduler->LeaveCPU()) {
+            return;  // Other CPUs ran meanwhile, and we have been
+                     // signalled.
+        }
         interrupt->Idle();  // No one to run, wait for an interrupt.
     }
     scheduler->Run(nextThread);  // Returns when we have been signalled.
@@ -317,11 +370,10 @@ Thread::StackAllocate(VoidFunctionPtr func, void *arg)
 {
     ASSERT(func != nullptr);
 
-    stack = (uintptr_t *)
-              SystemDep::AllocBoundedArray(STACK_SIZE * sizeof *stack);
+    stack = stackPool->Get(&stackSize);
 
     // Stacks in x86 work from high addresses to low addresses.
-    stackTop = stack + STACK_SIZE - 4;  // -4 to be on the safe side!
+    stackTop = stack + stackSize - 4;  // -4 to be on the safe side!
 
     // x86 passes the return address on the stack.  In order for `SWITCH` to
     // go to `ThreadRoot` when we switch to this thread, the return address
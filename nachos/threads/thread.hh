@@ -22,7 +22,8 @@
 /// small.)
 ///
 /// One thing to try if you find yourself with segmentation faults is to
-/// increase the size of thread stack -- `STACK_SIZE`.
+/// increase the size of thread stack -- `STACK_SIZE`, or that of a single
+/// thread with `Thread::SetStackSize`.
 ///
 /// In this interface, forking a thread takes two steps.  We must first
 /// allocate a data structure for it:
@@ -41,6 +42,7 @@
 #include "lib/utility.hh"
 
 #ifdef USER_PROGRAM
+#include "lib/list.hh"
 #include "machine/machine.hh"
 #include "userprog/address_space.hh"
 #endif
@@ -62,6 +64,10 @@ const unsigned MACHINE_STATE_SIZE = 17;
 /// WATCH OUT IF THIS IS NOT BIG ENOUGH!!!!!
 const unsigned STACK_SIZE = 4 * 1024;
 
+/// Share of the CPU of a thread under stride scheduling, unless it is given
+/// another one.
+const unsigned DEFAULT_WEIGHT = 1;
+
 
 /// Thread state.
 enum ThreadStatus {
@@ -126,6 +132,8 @@ public:
 
     void SetStatus(ThreadStatus st);
 
+    ThreadStatus GetStatus() const;
+
     const char *GetName() const;
 
     void Print() const;
@@ -134,6 +142,53 @@ public:
 
     int GetOriginalPriority();
     int GetPriority();
+
+    /// Size of the execution stack, in words; it may be rounded up when it
+    /// is allocated (see `StackPool`).
+    void SetStackSize(unsigned words);
+    unsigned GetStackSize() const;
+
+    /// Share of the CPU the thread gets under stride scheduling, relative
+    /// to the weights of the other threads.
+    void SetWeight(unsigned w);
+    unsigned GetWeight() const;
+
+    /// Links of the ready queue the thread is in, while it is `READY`.
+    ///
+    /// The queues are threaded through the threads themselves, so that the
+    /// scheduler can take a thread out of one in constant time.  Only the
+    /// scheduler touches them.
+    Thread *readyNext;
+    Thread *readyPrev;
+
+    /// Bookkeeping of the scheduler.  Ticks are those of
+    /// `stats->totalTicks`.
+
+    unsigned long readySince;    ///< When it was last made ready.
+    unsigned long dispatchedAt;  ///< When it last got the CPU.
+    unsigned long totalWait;     ///< Ticks spent ready, not running.
+    unsigned long maxWait;       ///< Longest wait for the CPU.
+    unsigned dispatches;         ///< Times it got the CPU.
+    unsigned long cpuTicks;      ///< Ticks spent running, up to the last
+                                 ///< time it left the CPU.
+    unsigned sliceTicks;         ///< Timer interrupts in its current time
+                                 ///< slice.
+    bool sliceExpired;           ///< Whether it used up its time slice.
+
+    /// Level of the thread in the multi-level feedback queue, valid while
+    /// `mlfqEpoch` is the current epoch of the scheduler (see
+    /// `Scheduler::MlfqLevel`).
+    int mlfqLevel;
+    unsigned mlfqEpoch;
+
+    /// Virtual time of the thread under stride scheduling: it advances
+    /// while the thread runs, the slower the higher its weight.
+    unsigned long pass;
+
+    /// CPU the thread last ran on; its run queue is the one the thread goes
+    /// to when it is ready, unless another CPU steals it.
+    unsigned cpu;
+
 private:
     // Some of the private data for this class is listed above.
 
@@ -141,6 +196,7 @@ private:
     ///
     /// Null if this is the main thread.  (If null, do not deallocate stack.)
     uintptr_t *stack;
+    unsigned stackSize;  ///< In words.
 
     /// Ready, running or blocked.
     ThreadStatus status;
@@ -151,6 +207,7 @@ private:
 
     int priority;
     int originalPriority;
+    unsigned weight;
 
 #ifdef USER_PROGRAM
 
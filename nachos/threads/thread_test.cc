@@ -16,6 +16,10 @@
 #include "thread_test_channel.hh"
 #include "thread_test_simple.hh"
 #include "thread_test_garden_sem.hh" //agregamos al inicio
+#include "thread_test_pending.hh"
+#include "thread_test_fork.hh"
+#include "thread_test_switch.hh"
+#include "thread_test_open_files.hh"
 #include "lib/utility.hh"
 
 #include <stdio.h>
@@ -34,7 +38,13 @@ static const Test TESTS[] = {
     { &ThreadTestGarden,   "garden",   "Ornamental garden" },
     { &ThreadTestProdCons, "prodcons", "Producer/Consumer" },
     { &ThreadTestGardenSem, "garden_sem", "Ornamental garden with semaphores" },
-    { &ThreadTestProdConsChannel, "prodcons_channel", "Producer/Consumer channel" }
+    { &ThreadTestProdConsChannel, "prodcons_channel", "Producer/Consumer channel" },
+    { &ThreadTestPending, "pending", "Pending interrupt queue benchmark" },
+    { &ThreadTestFork, "fork", "Thread fork and exit latency" },
+    { &ThreadTestSwitch, "switch", "Context switch cost" },
+    { &ThreadTestChannelThroughput, "channel", "Buffered channel throughput" },
+    { &ThreadTestProdConsThroughput, "synch_ring", "Synchronized ring throughput" },
+    { &ThreadTestOpenFiles, "open_files", "Open file table lookups" }
 };
 static const unsigned NUM_TESTS = sizeof TESTS / sizeof TESTS[0];
 
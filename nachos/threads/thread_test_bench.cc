@@ -0,0 +1,137 @@
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+
+#include "thread_test_bench.hh"
+#include "system.hh"
+#include "lib/utility.hh"
+#include "machine/system_dep.hh"
+
+#include <stdio.h>
+#include <string.h>
+
+
+/// Most columns a table may have.
+static const unsigned MAX_COLUMNS = 8;
+
+double
+NsPerOp(double start, unsigned ops)
+{
+    ASSERT(ops > 0);
+    return (SystemDep::HostTime() - start) * 1e9 / ops;
+}
+
+void
+PrintBenchTable(const char *sizeTitle,
+                const char *const *titles, unsigned numColumns,
+                const unsigned *sizes, unsigned numSizes,
+                void (*row)(unsigned size, double *times))
+{
+    ASSERT(sizeTitle != nullptr && titles != nullptr);
+    ASSERT(numColumns <= MAX_COLUMNS);
+    ASSERT(sizes != nullptr && row != nullptr);
+
+    printf("%s", sizeTitle);
+    for (unsigned c = 0; c < numColumns; c++) {
+        printf("  %s", titles[c]);
+    }
+    printf("\n");
+
+    for (unsigned i = 0; i < numSizes; i++) {
+        double times[MAX_COLUMNS];
+        row(sizes[i], times);
+        printf("%*u", (int) strlen(sizeTitle), sizes[i]);
+        for (unsigned c = 0; c < numColumns; c++) {
+            printf("  %*.0f", (int) strlen(titles[c]), times[c]);
+        }
+        printf("\n");
+    }
+}
+
+/// The measure being run by `MeasureThroughput`, for its threads.
+static const ThroughputBench *bench;
+static unsigned benchBatch;
+static PutFunction benchPut;
+static TakeFunction benchTake;
+
+/// Sum of the items taken by the consumers.
+static unsigned long takenSum;
+
+static void
+Producer(void *arg)
+{
+    int *items = new int [benchBatch];
+    for (unsigned i = 0; i < bench->items; i += benchBatch) {
+        unsigned n = bench->items - i < benchBatch
+                       ? bench->items - i : benchBatch;
+        for (unsigned j = 0; j < n; j++) {
+            items[j] = i + j;
+        }
+        benchPut(items, n);
+        if (bench->yieldEvery != 0 && (i + n) % bench->yieldEvery == 0) {
+            currentThread->Yield();
+        }
+    }
+    delete [] items;
+}
+
+static void
+Consumer(void *arg)
+{
+    int *items = new int [benchBatch];
+    unsigned long sum = 0;
+    unsigned left = bench->items;
+    while (left > 0) {
+        unsigned n = benchTake(items, left < benchBatch ? left : benchBatch);
+        ASSERT(n > 0 && n <= left);
+        for (unsigned j = 0; j < n; j++) {
+            sum += items[j];
+        }
+        left -= n;
+    }
+    takenSum += sum;
+    delete [] items;
+}
+
+void
+MeasureThroughput(const ThroughputBench &bench_, const char *what,
+                  unsigned batch, PutFunction put, TakeFunction take)
+{
+    ASSERT(what != nullptr && put != nullptr && take != nullptr);
+    ASSERT(bench_.pairs > 0 && bench_.items > 0 && batch > 0);
+
+    bench = &bench_;
+    benchBatch = batch;
+    benchPut = put;
+    benchTake = take;
+    takenSum = 0;
+
+    unsigned long ticks = stats->totalTicks;
+    unsigned long switches = stats->numContextSwitches;
+    double start = SystemDep::HostTime();
+
+    unsigned numThreads = 2 * bench->pairs;
+    Thread **threads = new Thread * [numThreads];
+    for (unsigned i = 0; i < numThreads; i++) {
+        bool producing = i < bench->pairs;
+        threads[i] = new Thread(producing ? "producer" : "consumer", true);
+        threads[i]->Fork(producing ? Producer : Consumer, nullptr);
+    }
+    for (unsigned i = 0; i < numThreads; i++) {
+        threads[i]->Join();
+    }
+    delete [] threads;
+
+    double elapsed = SystemDep::HostTime() - start;
+    double items = (double) bench->pairs * bench->items;
+    printf("%s: %.3f %ss per tick, %.0f %ss per host second, "
+           "%.2f context switches per %s\n",
+           what, items / (stats->totalTicks - ticks), bench->unit,
+           items / elapsed, bench->unit,
+           (stats->numContextSwitches - switches) / items, bench->unit);
+
+    // Every producer put `0` to `items - 1`.
+    ASSERT(takenSum == (unsigned long) bench->pairs
+                         * bench->items * (bench->items - 1) / 2);
+}
@@ -0,0 +1,49 @@
+/// Helpers shared by the thread tests that measure host time.
+///
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+#ifndef NACHOS_THREADS_THREADTESTBENCH__HH
+#define NACHOS_THREADS_THREADTESTBENCH__HH
+
+
+/// Host time since `start` (as given by `SystemDep::HostTime`), in
+/// nanoseconds for each of `ops` operations.
+double NsPerOp(double start, unsigned ops);
+
+/// Print a table with a row for each of the `numSizes` sizes in `sizes`:
+/// the size, under `sizeTitle`, and then the `numColumns` times that `row`
+/// stores in `times` for that size, under `titles`.
+void PrintBenchTable(const char *sizeTitle,
+                     const char *const *titles, unsigned numColumns,
+                     const unsigned *sizes, unsigned numSizes,
+                     void (*row)(unsigned size, double *times));
+
+/// Put the `n` items in `items` in the queue being measured.
+typedef void (*PutFunction)(const int *items, unsigned n);
+
+/// Take up to `max` items from the queue being measured into `items`, and
+/// return how many were taken, at least 1.
+typedef unsigned (*TakeFunction)(int *items, unsigned max);
+
+/// How to run a throughput measure with `MeasureThroughput`.
+struct ThroughputBench {
+    const char *unit;     ///< What is moved, like `message`.
+    unsigned pairs;       ///< Producers, and as many consumers.
+    unsigned items;       ///< Put by each producer, taken by each consumer.
+    unsigned yieldEvery;  ///< Producers yield after that many items, if not
+                          ///< 0, so that those of unbounded queues do not
+                          ///< just fill them before any consumer runs.
+};
+
+/// Fork the producers and consumers of `bench`, moving up to `batch` items
+/// at a time with `put` and `take`, wait for them and print, under `what`,
+/// how many items went through per simulated tick and per host second.
+///
+/// Producers put `0, 1, ...`; check that consumers took all of them.
+void MeasureThroughput(const ThroughputBench &bench, const char *what,
+                       unsigned batch, PutFunction put, TakeFunction take);
+
+
+#endif
@@ -2,8 +2,10 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include "thread_test_channel.hh"
+#include "thread_test_bench.hh"
 #include "system.hh"
 #include "channel.hh"
+#include "buffered_channel.hh"
 
 #define MC 3
 #define NC 3
@@ -69,3 +71,58 @@ void ThreadTestProdConsChannel() {
     delete []cnames;
     puts("Hilos finalizados");
 }
+
+
+/// Producers and consumers, and messages each of them sends or receives
+/// when measuring throughput.
+static const ThroughputBench BENCH = { "message", MC, 3000, 0 };
+
+/// Capacity of the buffered channel, and messages moved at once in batches.
+static const unsigned BENCH_CAPACITY = 16;
+
+static BufferedChannel *buffered;
+
+static void
+SendRendezvous(const int *messages, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) {
+        channel->Send(messages[i]);
+    }
+}
+
+static unsigned
+ReceiveRendezvous(int *messages, unsigned max)
+{
+    channel->Receive(messages);
+    return 1;
+}
+
+static void
+SendBuffered(const int *messages, unsigned n)
+{
+    buffered->SendMany(messages, n);
+}
+
+static unsigned
+ReceiveBuffered(int *messages, unsigned max)
+{
+    return buffered->ReceiveMany(messages, max);
+}
+
+/// Compare the throughput of the rendezvous `Channel` against a
+/// `BufferedChannel`, moving one message at a time and in batches.
+void
+ThreadTestChannelThroughput()
+{
+    channel = new Channel("rendezvous");
+    MeasureThroughput(BENCH, "Channel", 1,
+                      SendRendezvous, ReceiveRendezvous);
+    delete channel;
+
+    buffered = new BufferedChannel("buffered", BENCH_CAPACITY);
+    MeasureThroughput(BENCH, "Buffered channel", 1,
+                      SendBuffered, ReceiveBuffered);
+    MeasureThroughput(BENCH, "Buffered channel, batches", BENCH_CAPACITY,
+                      SendBuffered, ReceiveBuffered);
+    delete buffered;
+}
@@ -4,5 +4,7 @@
 
 void ThreadTestProdConsChannel();
 
+void ThreadTestChannelThroughput();
+
 
 #endif
@@ -0,0 +1,171 @@
+/// Measure how long it takes to fork a thread and have it finish, with
+/// stacks given back to the host as soon as their thread is destroyed (as
+/// it was done before the stack pool) and with stacks reused.
+///
+/// Threads are forked a few at a time and joined, like the short-lived
+/// threads of `Exec` are.
+///
+/// First, check that the pool hands out stacks of the class asked for,
+/// reuses them only within their class and up to its limit, and that
+/// threads on reused stacks start with a sound fencepost.
+///
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+
+#include "thread_test_fork.hh"
+#include "thread_test_bench.hh"
+#include "system.hh"
+
+#include <stdio.h>
+
+
+static const unsigned ROUNDS = 2000;
+
+/// Threads alive at the same time.
+static const unsigned BATCH = 8;
+
+static void
+Nothing(void *arg)
+{
+}
+
+/// Host time per thread, in nanoseconds.
+static double
+Run(unsigned stackSize, unsigned limit)
+{
+    stackPool->SetLimit(limit);
+
+    double start = SystemDep::HostTime();
+    for (unsigned i = 0; i < ROUNDS; i += BATCH) {
+        Thread *threads[BATCH];
+        for (unsigned j = 0; j < BATCH; j++) {
+            threads[j] = new Thread("forked", true);
+            threads[j]->SetStackSize(stackSize);
+            threads[j]->Fork(Nothing, nullptr);
+        }
+        for (unsigned j = 0; j < BATCH; j++) {
+            threads[j]->Join();
+        }
+    }
+    return NsPerOp(start, ROUNDS);
+}
+
+/// Size of the class of stacks of `words` words, or `words` itself if they
+/// are too big to be pooled.
+static unsigned
+ClassSize(unsigned words)
+{
+    unsigned size = MIN_STACK_SIZE;
+    while (size < words && size < MAX_POOLED_STACK_SIZE) {
+        size *= 2;
+    }
+    return size < words ? words : size;
+}
+
+/// Check `Get` and `Put` on a pool of our own, keeping one stack of each
+/// class.
+static void
+CheckPool()
+{
+    static const unsigned REQUESTS[] = {
+        1, MIN_STACK_SIZE, MIN_STACK_SIZE + 1, 3 * MIN_STACK_SIZE,
+        MAX_POOLED_STACK_SIZE, MAX_POOLED_STACK_SIZE + 1
+    };
+
+    StackPool pool(1);
+    for (unsigned i = 0; i < sizeof REQUESTS / sizeof REQUESTS[0]; i++) {
+        unsigned size = REQUESTS[i];
+        uintptr_t *stack = pool.Get(&size);
+        ASSERT(stack != nullptr);
+        ASSERT(size == ClassSize(REQUESTS[i]));
+        stack[0] = stack[size - 1] = 0;  // All of it is ours.
+        pool.Put(stack, size);
+        if (size > MAX_POOLED_STACK_SIZE) {
+            continue;
+        }
+
+        // A stack given back goes to requests of its class only.
+        unsigned other = size == MIN_STACK_SIZE ? 2 * size : size / 2;
+        uintptr_t *otherStack = pool.Get(&other);
+        ASSERT(otherStack != stack);
+        pool.Put(otherStack, other);
+        unsigned again = REQUESTS[i];
+        ASSERT(pool.Get(&again) == stack && again == size);
+
+        // Only one of two stacks given back is kept: had both been kept,
+        // the last one would come out first.
+        unsigned second = size;
+        uintptr_t *secondStack = pool.Get(&second);
+        ASSERT(secondStack != stack);
+        pool.Put(stack, size);
+        pool.Put(secondStack, second);
+        again = size;
+        ASSERT(pool.Get(&again) == stack);
+        pool.Put(stack, size);
+    }
+}
+
+/// Run by threads forked on a stack of `*(unsigned *) arg` words.
+static void
+CheckStack(void *arg)
+{
+    unsigned words = *(unsigned *) arg;
+    currentThread->CheckOverflow();
+    ASSERT(currentThread->GetStackSize() == ClassSize(words));
+}
+
+/// Fork threads on stacks of every class, several times, so that most of
+/// them get a stack some other thread used.
+static void
+CheckThreads()
+{
+    static const unsigned WORDS[] = {
+        STACK_SIZE, MIN_STACK_SIZE + 1, MAX_POOLED_STACK_SIZE
+    };
+    static const unsigned NUM_WORDS = sizeof WORDS / sizeof WORDS[0];
+
+    for (unsigned round = 0; round < 3; round++) {
+        Thread *threads[NUM_WORDS];
+        for (unsigned i = 0; i < NUM_WORDS; i++) {
+            threads[i] = new Thread("checked", true);
+            threads[i]->SetStackSize(WORDS[i]);
+            threads[i]->Fork(CheckStack, (void *) &WORDS[i]);
+        }
+        for (unsigned i = 0; i < NUM_WORDS; i++) {
+            threads[i]->Join();
+        }
+    }
+}
+
+/// The limit of the pool to use in the measurements.
+static unsigned poolLimit;
+
+static void
+Row(unsigned size, double *times)
+{
+    times[0] = Run(size, 0);
+    times[1] = Run(size, poolLimit > BATCH ? poolLimit : BATCH);
+}
+
+void
+ThreadTestFork()
+{
+    static const unsigned SIZES[] = {
+        MIN_STACK_SIZE, STACK_SIZE, MAX_POOLED_STACK_SIZE
+    };
+    static const char *const TITLES[] = {
+        "Fork+exit, no pool (ns)", "Fork+exit, pool (ns)"
+    };
+
+    CheckPool();
+    CheckThreads();
+    printf("Stack pool checked.\n");
+
+    poolLimit = stackPool->GetLimit();
+    PrintBenchTable("Stack (words)", TITLES, 2,
+                    SIZES, sizeof SIZES / sizeof SIZES[0], Row);
+    stackPool->SetLimit(poolLimit);
+    stackPool->Print();
+}
@@ -0,0 +1,200 @@
+/// Measure the table of open files, keyed by the sector of their header,
+/// kept as a `SynchList` looked up by key (as it was before) and as a
+/// `SynchHashTable`.
+///
+/// Opening a file that is already open looks its header up (`HasKey` and
+/// then getting it), and closing the last reference to a file and opening
+/// another one removes a header and adds one.  Files are closed in random
+/// order, as otherwise those of the list would end up sorted in the order
+/// they are closed, and every one would be found first.
+///
+/// First, check that the hash table keeps every key while it grows, and
+/// that it finds, removes and adds them back as the list would; and that
+/// a file closed and opened again gets the same identifier, while a process
+/// identifier is not given again.
+///
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+
+#include "thread_test_open_files.hh"
+#include "thread_test_bench.hh"
+#include "synch_hash_table.hh"
+#include "synch_list.hh"
+#include "system.hh"
+#include "lib/table.hh"
+
+#include <stdio.h>
+
+
+static const unsigned ROUNDS = 20000;
+
+/// Stands for the header of every open file.
+static int header;
+
+/// Sector of the header of the `i`-th open file; headers of files created
+/// one after the other are a few sectors apart.
+static int
+SectorOf(unsigned i)
+{
+    return 2 + 5 * i;
+}
+
+/// Keys checked, enough for the table to double its buckets a few times.
+static const unsigned CHECK_KEYS = 1000;
+
+/// Check a table with the headers of `CHECK_KEYS` open files, `headers[i]`
+/// being that of the `i`-th one.
+static void
+CheckHashTable()
+{
+    static int headers[CHECK_KEYS];
+
+    HashTable<int *> table;
+    for (unsigned i = 0; i < CHECK_KEYS; i++) {
+        table.Add(SectorOf(i), &headers[i]);
+        ASSERT(table.Size() == i + 1);
+    }
+
+    // Every key is still there after growing, and sectors between those of
+    // open files are not.
+    for (unsigned i = 0; i < CHECK_KEYS; i++) {
+        ASSERT(table.HasKey(SectorOf(i)));
+        ASSERT(table.Get(SectorOf(i)) == &headers[i]);
+        ASSERT(!table.HasKey(SectorOf(i) + 1));
+        ASSERT(table.Get(SectorOf(i) + 1) == nullptr);
+    }
+
+    // Close every other file, and then open them again.
+    for (unsigned i = 0; i < CHECK_KEYS; i += 2) {
+        ASSERT(table.Remove(SectorOf(i)) == &headers[i]);
+        ASSERT(table.Remove(SectorOf(i)) == nullptr);
+    }
+    ASSERT(table.Size() == CHECK_KEYS / 2);
+    for (unsigned i = 0; i < CHECK_KEYS; i++) {
+        ASSERT(table.HasKey(SectorOf(i)) == (i % 2 == 1));
+    }
+    for (unsigned i = 0; i < CHECK_KEYS; i += 2) {
+        table.Add(SectorOf(i), &headers[i]);
+    }
+    for (unsigned i = 0; i < CHECK_KEYS; i++) {
+        ASSERT(table.Get(SectorOf(i)) == &headers[i]);
+    }
+
+    // Only the first header added for a sector is kept.
+    SynchHashTable<int *> synchTable;
+    ASSERT(synchTable.GetOrAdd(SectorOf(0), &headers[0]) == &headers[0]);
+    ASSERT(synchTable.GetOrAdd(SectorOf(0), &headers[1]) == &headers[0]);
+    ASSERT(synchTable.Get(SectorOf(0)) == &headers[0]);
+
+    printf("Hash table checked.\n");
+}
+
+/// Check the identifiers handed out by tables of open files of a process
+/// and of processes.
+static void
+CheckIds()
+{
+    // Like that of a thread, with the console taking the first two.
+    Table<int *> files;
+    ASSERT(files.Add(nullptr) == 0 && files.Add(nullptr) == 1);
+    int fid = files.Add(&header);
+    ASSERT(fid == 2);
+    ASSERT(files.Remove(fid) == &header);
+    ASSERT(!files.HasKey(fid));
+    ASSERT(files.Add(&header) == fid);
+
+    Table<int *> processes(true);
+    int sid = processes.Add(&header);
+    ASSERT(processes.Remove(sid) == &header);
+    int next = processes.Add(&header);
+    ASSERT(next != sid && !processes.HasKey(sid));
+    ASSERT(processes.Get(next) == &header);
+
+    printf("Table ids checked.\n");
+}
+
+/// Host time per operation with `n` open files kept in a list, in
+/// nanoseconds, for opening a file (`*open`) and for closing one and
+/// opening another (`*churn`).
+static void
+RunList(unsigned n, double *open, double *churn)
+{
+    SynchList<int *> *table = new SynchList<int *>;
+    for (unsigned i = 0; i < n; i++) {
+        table->AppendKey(&header, SectorOf(i));
+    }
+
+    double start = SystemDep::HostTime();
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        int sector = SectorOf(i * 7 % n);
+        if (table->HasKey(sector)) {
+            ASSERT(table->GetByKey(sector) == &header);
+        }
+    }
+    *open = NsPerOp(start, ROUNDS);
+
+    start = SystemDep::HostTime();
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        int sector = SectorOf(SystemDep::Random() % n);
+        table->RemoveByKey(sector);
+        table->AppendKey(&header, sector);
+    }
+    *churn = NsPerOp(start, ROUNDS);
+
+    delete table;
+}
+
+/// The same as `RunList`, with the files kept in a hash table.
+static void
+RunHashTable(unsigned n, double *open, double *churn)
+{
+    SynchHashTable<int *> *table = new SynchHashTable<int *>;
+    for (unsigned i = 0; i < n; i++) {
+        table->Add(SectorOf(i), &header);
+    }
+
+    double start = SystemDep::HostTime();
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        int sector = SectorOf(i * 7 % n);
+        if (table->HasKey(sector)) {
+            ASSERT(table->Get(sector) == &header);
+        }
+    }
+    *open = NsPerOp(start, ROUNDS);
+
+    start = SystemDep::HostTime();
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        int sector = SectorOf(SystemDep::Random() % n);
+        table->Remove(sector);
+        table->Add(sector, &header);
+    }
+    *churn = NsPerOp(start, ROUNDS);
+
+    delete table;
+}
+
+/// Measure both tables with `n` open files, for `PrintBenchTable`.
+static void
+Row(unsigned n, double *times)
+{
+    RunList(n, &times[0], &times[2]);
+    RunHashTable(n, &times[1], &times[3]);
+}
+
+void
+ThreadTestOpenFiles()
+{
+    static const unsigned SIZES[] = { 10, 100, 1000 };
+    static const char *const TITLES[] = {
+        "Open, list (ns)", "Open, hash (ns)",
+        "Close+open, list (ns)", "Close+open, hash (ns)"
+    };
+
+    CheckHashTable();
+    CheckIds();
+
+    PrintBenchTable("Open files", TITLES, sizeof TITLES / sizeof TITLES[0],
+                    SIZES, sizeof SIZES / sizeof SIZES[0], Row);
+}
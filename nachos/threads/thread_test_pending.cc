@@ -0,0 +1,144 @@
+/// Compare the queue of pending interrupts against the sorted `List` it
+/// replaced.
+///
+/// Both go through the same workload: with `n` interrupts pending, take the
+/// earliest out and schedule it again a random time later, as devices do.
+/// The old way also allocated a node per `Schedule`.
+///
+/// First, check that the queue gives interrupts back in the order they are
+/// due, those due at the same time in the order they were inserted.
+///
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+
+#include "thread_test_pending.hh"
+#include "thread_test_bench.hh"
+#include "system.hh"
+
+#include <stdio.h>
+
+
+static const unsigned ROUNDS = 200000;
+
+/// How far in the future interrupts get scheduled.
+static const unsigned SPREAD = 1000;
+
+static void
+Dummy(void *arg)
+{
+}
+
+static double
+RunList(unsigned n)
+{
+    List<PendingInterrupt *> list;
+    SystemDep::RandomInit(n);
+    for (unsigned i = 0; i < n; i++) {
+        unsigned when = SystemDep::Random() % SPREAD;
+        list.SortedInsert(new PendingInterrupt(Dummy, nullptr, when,
+                                               TIMER_INT), when);
+    }
+
+    double start = SystemDep::HostTime();
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        int now;
+        delete list.SortedPop(&now);
+        unsigned when = now + 1 + SystemDep::Random() % SPREAD;
+        list.SortedInsert(new PendingInterrupt(Dummy, nullptr, when,
+                                               TIMER_INT), when);
+    }
+    double elapsed = NsPerOp(start, ROUNDS);
+
+    while (!list.IsEmpty()) {
+        delete list.Pop();
+    }
+    return elapsed;
+}
+
+static double
+RunQueue(unsigned n)
+{
+    PendingQueue queue;
+    SystemDep::RandomInit(n);
+    for (unsigned i = 0; i < n; i++) {
+        unsigned when = SystemDep::Random() % SPREAD;
+        queue.Insert(queue.Allocate(Dummy, nullptr, when, TIMER_INT));
+    }
+
+    double start = SystemDep::HostTime();
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        PendingInterrupt *pend = queue.Pop();
+        unsigned long now = pend->when;
+        queue.Free(pend);
+        unsigned long when = now + 1 + SystemDep::Random() % SPREAD;
+        queue.Insert(queue.Allocate(Dummy, nullptr, when, TIMER_INT));
+    }
+    return NsPerOp(start, ROUNDS);
+}
+
+/// Insert `n` interrupts, many of them due at the same time, and take them
+/// all out, interleaving some more insertions.
+static void
+CheckQueue(unsigned n)
+{
+    PendingQueue queue;
+    SystemDep::RandomInit(n);
+
+    // The argument of each interrupt tells the order it was inserted in.
+    uintptr_t inserted = 0;
+    for (; inserted < n; inserted++) {
+        unsigned long when = SystemDep::Random() % (n / 4 + 1);
+        queue.Insert(queue.Allocate(Dummy, (void *) inserted, when,
+                                    TIMER_INT));
+    }
+
+    unsigned long lastWhen = 0;
+    uintptr_t lastInserted = 0;
+    unsigned popped = 0;
+    for (bool first = true; !queue.IsEmpty(); first = false) {
+        ASSERT(queue.Head() != nullptr);
+        PendingInterrupt *pend = queue.Pop();
+        uintptr_t order = (uintptr_t) pend->arg;
+        ASSERT(first || pend->when > lastWhen
+               || (pend->when == lastWhen && order > lastInserted));
+        lastWhen = pend->when;
+        lastInserted = order;
+        queue.Free(pend);
+        popped++;
+
+        // Schedule another one, due no earlier than the last taken out.
+        if (popped % 3 == 0) {
+            unsigned long when = lastWhen + SystemDep::Random() % 3;
+            queue.Insert(queue.Allocate(Dummy, (void *) inserted++, when,
+                                        TIMER_INT));
+        }
+    }
+    ASSERT(popped == inserted);
+    ASSERT(queue.Pop() == nullptr);
+}
+
+static void
+Row(unsigned n, double *times)
+{
+    times[0] = RunList(n);
+    times[1] = RunQueue(n);
+}
+
+void
+ThreadTestPending()
+{
+    static const unsigned SIZES[] = { 3, 10, 100, 1000 };
+    static const unsigned NUM_SIZES = sizeof SIZES / sizeof SIZES[0];
+    static const char *const TITLES[] = {
+        "List (ns/op)", "PendingQueue (ns/op)"
+    };
+
+    for (unsigned i = 0; i < NUM_SIZES; i++) {
+        CheckQueue(SIZES[i]);
+    }
+    printf("Pending queue order checked.\n");
+
+    PrintBenchTable("Pending", TITLES, 2, SIZES, NUM_SIZES, Row);
+}
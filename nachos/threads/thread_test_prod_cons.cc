@@ -2,9 +2,12 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include "thread_test_prod_cons.hh"
+#include "thread_test_bench.hh"
 #include "system.hh"
 #include "lock.hh"
 #include "condition.hh"
+#include "synch_list.hh"
+#include "synch_ring.hh"
 
 #define M 1
 #define N 1
@@ -97,3 +100,59 @@ void ThreadTestProdCons() {
     delete []cnames;
     puts("Hilos finalizados");
 }
+
+
+/// Capacity of the ring, and items moved at once in batches.
+static const unsigned BENCH_CAPACITY = 32;
+
+/// Producers and consumers, and items each of them appends or removes when
+/// measuring throughput.  Producers yield after every `BENCH_CAPACITY`
+/// items, so that those of the unbounded list do not just fill it before
+/// any consumer runs.
+static const ThroughputBench BENCH = { "item", 2, 5000, BENCH_CAPACITY };
+
+static SynchList<int> *benchList;
+static SynchRing<int> *benchRing;
+
+static void
+AppendList(const int *items, unsigned n)
+{
+    for (unsigned i = 0; i < n; i++) {
+        benchList->Append(items[i]);
+    }
+}
+
+static unsigned
+PopList(int *items, unsigned max)
+{
+    items[0] = benchList->Pop();
+    return 1;
+}
+
+static void
+AppendRing(const int *items, unsigned n)
+{
+    benchRing->AppendMany(items, n);
+}
+
+static unsigned
+RemoveRing(int *items, unsigned max)
+{
+    return benchRing->RemoveMany(items, max);
+}
+
+/// Compare the throughput of `SynchList` against `SynchRing`, moving one
+/// item at a time and in batches.
+void
+ThreadTestProdConsThroughput()
+{
+    benchList = new SynchList<int>;
+    MeasureThroughput(BENCH, "SynchList", 1, AppendList, PopList);
+    delete benchList;
+
+    benchRing = new SynchRing<int>(BENCH_CAPACITY);
+    MeasureThroughput(BENCH, "SynchRing", 1, AppendRing, RemoveRing);
+    MeasureThroughput(BENCH, "SynchRing, batches", BENCH_CAPACITY,
+                      AppendRing, RemoveRing);
+    delete benchRing;
+}
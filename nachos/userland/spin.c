@@ -0,0 +1,30 @@
+/// CPU-bound program for the stride scheduling benchmark (see `share.c`).
+///
+/// Spins for the number of rounds given as its argument (1 by default), and
+/// exits.
+
+
+#include "syscall.h"
+
+
+/// Iterations of the loop in a round.
+#define ROUND  65536
+
+int
+main(int argc, char *argv[])
+{
+    int rounds = 0;
+
+    if (argc > 1) {
+        for (const char *s = argv[1]; *s >= '0' && *s <= '9'; s++) {
+            rounds = rounds * 10 + *s - '0';
+        }
+    }
+    if (rounds <= 0) {
+        rounds = 1;
+    }
+
+    for (volatile int i = rounds * ROUND; i > 0; i--) {}
+
+    Exit(0);
+}
@@ -69,6 +69,14 @@ Exec2:
         j       $31
         .end    Exec2
 
+        .globl  ExecWeighted
+        .ent    ExecWeighted
+ExecWeighted:
+        addiu   $2, $0, SC_EXECW
+        syscall
+        j       $31
+        .end    ExecWeighted
+
         .globl  Join
         .ent    Join
 Join:
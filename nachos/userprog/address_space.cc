@@ -41,9 +41,47 @@
  *                 Accesos a memoria: 22614301
 */
 
+/***
+ * Comparación de políticas de reemplazo de la TLB (`-tlbp`), vmem con el
+ * algoritmo mejorado del reloj, MEMORY 32 pages.  Tasa de fallos =
+ * fallos de TLB / (aciertos + fallos); incluye los fallos de memoria.
+ *
+ * TLB 4 entradas (totalmente asociativa):
+ *                 matmult                 sort
+ *       FIFO      51996 (14.14%)          44592 (0.47%)
+ *       Random    44876 (12.35%)          60254 (0.63%)
+ *       LRU       41673 (11.34%)          46065 (0.48%)
+ *       NRU       43623 (11.99%)          52093 (0.55%)
+ *
+ * TLB 16 entradas, 2 vías (-tlb 16 -tlbw 2):
+ *                 matmult                 sort
+ *       FIFO       6178 (1.82%)            7616 (0.08%)
+ *       Random     7041 (2.07%)           10653 (0.11%)
+ *       LRU        6405 (1.89%)            7482 (0.08%)
+ *       NRU        6490 (1.91%)            8396 (0.09%)
+*/
+
+/***
+ * Comparación de políticas de reemplazo de páginas (`-prp`), vmem, TLB 4
+ * entradas, MEMORY 32 pages.  Fallos de memoria / páginas llevadas a swap
+ * / páginas traídas de swap:
+ *                 matmult                 sort
+ *       FIFO        97 /   46 /   50      2220 / 2055 / 2051
+ *       Random      97 /   39 /   50       378 /  329 /  325
+ *       Reloj       87 /   28 /   37      1533 / 1497 / 1494
+ *       Aging       74 /   36 /   31      2021 / 1989 / 1985
+ *       WSClock     72 /   31 /   28      2022 / 1989 / 1985
+ *
+ * sort recorre una y otra vez un arreglo más grande que la memoria: para
+ * ese patrón LRU es lo peor posible, y aging y WSClock, que lo aproximan
+ * mejor que el reloj, quedan cerca de FIFO.
+*/
+
 
 #include "address_space.hh"
 #include "executable.hh"
+#include "page_policy.hh"
+#include "tlb_policy.hh"
 #include "threads/system.hh"
 #include "lib/coremap.hh"
 #include "machine/statistics.hh"
@@ -64,7 +102,6 @@ AddressSpace::AddressSpace(OpenFile *executable_file)
 
     exe_file = executable_file;
 
-    nextReplace = 0;
     //pf = 0;
     // How big is address space?
 
@@ -91,7 +128,7 @@ AddressSpace::AddressSpace(OpenFile *executable_file)
     #ifndef DEMAND_LOADING
     for (unsigned i = 0; i < numPages; i++) {
         pageTable[i].virtualPage  = i;
-        int physicalPage = memoryPages->Find(pageTable[i].virtualPage);
+        int physicalPage = memoryPages->Find(this, pageTable[i].virtualPage);
         if(physicalPage == -1){
           DEBUG('a', "No space on memory to allocate the process.");
           ASSERT(false);
@@ -104,6 +141,7 @@ AddressSpace::AddressSpace(OpenFile *executable_file)
         char *mainMemory = machine->mainMemory;
         unsigned offset = physicalPage * PAGE_SIZE;
         memset(mainMemory + offset, 0, PAGE_SIZE);
+        machine->GetMMU()->InvalidateFrame(physicalPage);
 
     }
 
@@ -175,13 +213,21 @@ AddressSpace::~AddressSpace()
     }
     delete [] pageTable;
     delete exe_file;
+
+    // The TLB keeps entries of every address space; drop ours so that they
+    // are not taken for those of whoever gets our identifier next.  We may
+    // have run on any CPU.
+    if (machine->GetMMU()->tlb != nullptr) {
+        for (unsigned i = 0; i < machine->GetNumCPUs(); i++) {
+            machine->GetMMU(i)->FlushTLB(currentThread->sid);
+        }
+    }
     
     #ifdef SWAP
     delete [] InSwap;
-    char * swap = new char[7];
-    sprintf(swap, "SWAP.%u", currentThread->sid);
+    char swap[SWAP_NAME_SIZE];
+    SwapFileName(currentThread->sid, swap);
     fileSystem->Remove(swap);
-    delete [] swap;
 
     #endif
 
@@ -218,16 +264,17 @@ AddressSpace::InitRegisters()
 /// On a context switch, save any machine state, specific to this address
 /// space, that needs saving.
 ///
-/// For now, nothing!
+/// With a TLB, copy the use and dirty bits of our entries back to the page
+/// table.  The entries themselves stay in the TLB.
 void
 AddressSpace::SaveState()
 {
-    if((machine->GetMMU()->tlb) != nullptr && currentThread->space != nullptr){
-      for (unsigned i = 0; i < TLB_SIZE; i++) {
-        if(machine->GetMMU()->tlb[i].valid){
-          pageTable[machine->GetMMU()->tlb[i].virtualPage].use = machine->GetMMU()->tlb[i].use;
-          pageTable[machine->GetMMU()->tlb[i].virtualPage].dirty = machine->GetMMU()->tlb[i].dirty;
-        }  
+    MMU *mmu = machine->GetMMU();
+    if(mmu->tlb != nullptr && currentThread->space != nullptr){
+      for (unsigned i = 0; i < mmu->GetTLBSize(); i++) {
+        if(mmu->tlb[i].valid && mmu->tlb[i].asid == currentThread->sid){
+          SyncTLBEntry(&mmu->tlb[i]);
+        }
       }
     }
 }
@@ -235,21 +282,85 @@ AddressSpace::SaveState()
 /// On a context switch, restore the machine state so that this address space
 /// can run.
 ///
-/// For now, tell the machine where to find the page table.
+/// With a TLB, make our entries the ones in use; they are tagged with our
+/// process identifier, so there is no need to flush the others.  Otherwise,
+/// tell the machine where to find the page table.
 void
 AddressSpace::RestoreState()
 {
     if((machine->GetMMU()->tlb) != nullptr){
-      for (unsigned i = 0; i < TLB_SIZE; i++) {
-        machine->GetMMU()->tlb[i].valid = false;
-      }
-    nextReplace = 0;
+      machine->GetMMU()->SetASID(currentThread->sid);
     }
     else{
       machine->GetMMU()->pageTable     = pageTable;
       machine->GetMMU()->pageTableSize = numPages;
     }
 }
+/// Copy the use and dirty bits of a TLB entry back into the page table of
+/// the address space it belongs to.
+///
+/// The use bit is only ever set this way: TLB replacement policies clear
+/// it in the TLB after calling this, and the page table must not forget
+/// that the page was used.  As bits are only ever added, copies of the
+/// entry in the TLBs of other CPUs, maybe clean, can be synchronized later.
+void
+AddressSpace::SyncTLBEntry(const TranslationEntry *entry)
+{
+    ASSERT(entry != nullptr && entry->valid);
+
+    Thread *owner = processesTable->Get(entry->asid);
+    ASSERT(owner != nullptr && owner->space != nullptr);
+    TranslationEntry *e = &owner->space->pageTable[entry->virtualPage];
+    e->use = e->use || entry->use;
+    e->dirty = e->dirty || entry->dirty;
+}
+
+/// Pick the TLB entry where `page` is to be loaded: an invalid entry of its
+/// set if there is one, otherwise the one chosen by the TLB replacement
+/// policy.
+static unsigned
+PickTLBEntry(unsigned page)
+{
+    MMU *mmu = machine->GetMMU();
+    unsigned ways = mmu->GetTLBWays();
+    unsigned first = mmu->TLBSet(page);
+
+    for (unsigned i = first; i < first + ways; i++) {
+        if (!mmu->tlb[i].valid) {
+            return i;
+        }
+    }
+    return tlbPolicies[machine->GetCPU()]->PickVictim(mmu->tlb, first, ways);
+}
+
+/// Copy back the use and dirty bits of the TLB entries, on any CPU, that
+/// map physical page `frame`, and clear their use bits, so that the page
+/// table tells whether the page is used from now on.
+///
+/// Returns the entry of the page in the page table of its owner, or null
+/// if the frame is free.
+TranslationEntry *
+AddressSpace::SyncFrame(unsigned frame)
+{
+    if (!memoryPages->InUse(frame)) {
+        return nullptr;
+    }
+    for (unsigned c = 0; c < machine->GetNumCPUs(); c++) {
+        MMU *mmu = machine->GetMMU(c);
+        if (mmu->tlb == nullptr) {
+            break;
+        }
+        for (unsigned i = 0; i < mmu->GetTLBSize(); i++) {
+            if (mmu->tlb[i].valid && mmu->tlb[i].physicalPage == frame) {
+                SyncTLBEntry(&mmu->tlb[i]);
+                mmu->tlb[i].use = false;
+            }
+        }
+    }
+    AddressSpace *owner = memoryPages->Owner(frame);
+    return &owner->pageTable[memoryPages->VirtualPage(frame)];
+}
+
 int fauls = 0;
 bool
 AddressSpace::LoadTLB(unsigned page)
@@ -259,46 +370,50 @@ AddressSpace::LoadTLB(unsigned page)
 
     if(!pageTable[page].valid){
       stats->memoryPageFaults++;
+      pagePolicy->Sample();
       DEBUG('e', "Page %d to be loaded in page table\n", page);
 
       //buscar pagina fisica
-      unsigned physicalPage = memoryPages->Find(pageTable[page].virtualPage);
+      unsigned physicalPage = memoryPages->Find(this, pageTable[page].virtualPage);
 
       if(physicalPage == (unsigned)-1){
         #ifdef SWAP
         //bandera w para debugear mas limpio
         DEBUG('w', "Tengo que swappear paginas, no hay espacio.\n");
 
-        physicalPage = PickVictim();
+        physicalPage = pagePolicy->PickVictim();
+        // Nobody may take the frame while the victim goes out of it and our
+        // page comes in.
+        memoryPages->Pin(physicalPage);
+        AddressSpace *victimSpace = memoryPages->Owner(physicalPage);
         unsigned victimProccessId = memoryPages->ProccessID(physicalPage);
         unsigned victimVirtualPage = memoryPages->VirtualPage(physicalPage);
 
-        processesTable->Get(victimProccessId)->space->Invalidate(victimVirtualPage);
-        if(victimProccessId == currentThread->sid){
-          DEBUG('w', "me quite una pagina a mi mismo, invalidando en TLB\n");
-          //invalido en tlb y ademas sincronizo bit dirty, para poder usarlo mas abajo
-          for(unsigned i = 0; i < TLB_SIZE; i++){
-            if(machine->GetMMU()->tlb[i].physicalPage == physicalPage && machine->GetMMU()->tlb[i].valid) {
-              unsigned virtualPage = machine->GetMMU()->tlb[i].virtualPage;
-              pageTable[virtualPage].dirty = machine->GetMMU()->tlb[i].dirty;
-              pageTable[virtualPage].use = machine->GetMMU()->tlb[i].use;
-              machine->GetMMU()->tlb[i].valid = false;
-            } 
+        // La víctima puede estar en la TLB aunque no sea del proceso
+        // actual, y en la de cualquier CPU: invalidarla y sincronizar el
+        // bit dirty, para poder usarlo más abajo.
+        for(unsigned c = 0; c < machine->GetNumCPUs(); c++){
+          MMU *mmu = machine->GetMMU(c);
+          for(unsigned i = 0; i < mmu->GetTLBSize(); i++){
+            if(mmu->tlb[i].physicalPage == physicalPage && mmu->tlb[i].valid) {
+              DEBUG('w', "invalidando en TLB la pagina victima\n");
+              SyncTLBEntry(&mmu->tlb[i]);
+              mmu->tlb[i].valid = false;
+            }
           }
         }
-        memoryPages->Mark(physicalPage, pageTable[page].virtualPage);
+        victimSpace->Invalidate(victimVirtualPage);
+        memoryPages->Mark(physicalPage, this, pageTable[page].virtualPage);
         bool mustSwap = true;
-        AddressSpace *victimSpace = processesTable->Get(victimProccessId)->space;
         mustSwap = mustSwap && !victimSpace->ReadOnly(victimVirtualPage);
         mustSwap = mustSwap && (!victimSpace->InSwap[victimVirtualPage] || victimSpace->Dirty(victimVirtualPage));
         if(mustSwap){
-          char *victimSwap = new char[7];
-          sprintf(victimSwap, "SWAP.%u", victimProccessId);
+          char victimSwap[SWAP_NAME_SIZE];
+          SwapFileName(victimProccessId, victimSwap);
           DEBUG('w', "mandando pagina %d a swap\n", physicalPage);
           OpenFile* openFile = fileSystem->Open(victimSwap);
           openFile->WriteAt(machine->mainMemory + physicalPage*PAGE_SIZE, PAGE_SIZE, victimVirtualPage*PAGE_SIZE);
           delete openFile;
-          delete [] victimSwap;
           victimSpace->InSwap[victimVirtualPage] = true;
           stats->carryToSwap++;
         }
@@ -309,6 +424,8 @@ AddressSpace::LoadTLB(unsigned page)
         DEBUG('a', "No space on memory to allocate the process.\n");
         ASSERT(false);
         #endif
+      } else {
+        memoryPages->Pin(physicalPage);
       }
       bool inSwap = false;
       #ifdef SWAP
@@ -318,17 +435,18 @@ AddressSpace::LoadTLB(unsigned page)
       pageTable[page].valid        = true;
       char *mainMemory = machine->mainMemory;
       memset(mainMemory + physicalPage*PAGE_SIZE, 0, PAGE_SIZE);
+      // El contenido del marco cambia: descartar lo decodificado de él.
+      machine->GetMMU()->InvalidateFrame(physicalPage);
       if(inSwap){
         #ifdef SWAP
         DEBUG('w', "Trayendo pagina virtual %d de swap\n", page);
 
-        char * swap = new char[7];
-        sprintf(swap, "SWAP.%u", currentThread->sid);
+        char swap[SWAP_NAME_SIZE];
+        SwapFileName(currentThread->sid, swap);
 
         OpenFile* openFile = fileSystem->Open(swap);
         openFile->ReadAt(machine->mainMemory + physicalPage*PAGE_SIZE, PAGE_SIZE, pageTable[page].virtualPage * PAGE_SIZE);
         delete openFile;
-        delete [] swap;
         pageTable[page].dirty = false;
         pageTable[page].use = false;
 
@@ -358,82 +476,43 @@ AddressSpace::LoadTLB(unsigned page)
         }
         //sino ya esta lleno de ceros
       }
+      pagePolicy->Loaded(physicalPage);
+      memoryPages->Unpin(physicalPage);
     }
     //DEBUG('w', "Reemplazando en tlb\n");
-    if(machine->GetMMU()->tlb[nextReplace % TLB_SIZE].valid){
-      pageTable[machine->GetMMU()->tlb[nextReplace % TLB_SIZE].virtualPage].use = machine->GetMMU()->tlb[nextReplace % TLB_SIZE].use;
-      pageTable[machine->GetMMU()->tlb[nextReplace % TLB_SIZE].virtualPage].dirty = machine->GetMMU()->tlb[nextReplace % TLB_SIZE].dirty;
+    unsigned i = PickTLBEntry(page);
+    TranslationEntry *entry = &machine->GetMMU()->tlb[i];
+    if(entry->valid){
+      SyncTLBEntry(entry);
     }
-    machine->GetMMU()->tlb[nextReplace % TLB_SIZE] = pageTable[page];
-    nextReplace++;
-    nextReplace%=TLB_SIZE;
+    *entry = pageTable[page];
+    entry->asid = currentThread->sid;
+    tlbPolicies[machine->GetCPU()]->Loaded(machine->GetMMU()->tlb, i);
     //DEBUG('w', "Termine de reemplazar %d %d\n", page, numPages);
     return true;
 }
 
-unsigned
-AddressSpace::NumPages()
-{
-    return numPages;
-}
+#ifdef SWAP
+int AddressSpace::batchInstance = -1;
 
-int
-AddressSpace::PickVictim()
+void
+AddressSpace::SwapFileName(unsigned sid, char *name)
 {
+    ASSERT(name != nullptr);
 
-  #ifdef PRPOLICY_CLOCK
-    int snd = -1, trd = -1, fth = -1;
-    bool dirty = false, use = false;
-    unsigned init = memoryPages->NextFIFOPointer();
-    
-    //Recorre una vuelta entera a la memoryPages
-    for(unsigned i = init, steps = 0; steps < memoryPages->NumItems(); i = memoryPages->NextFIFOPointer(), steps++) {
-      dirty = pageTable[memoryPages->VirtualPage(i)].dirty;
-      use = pageTable[memoryPages->VirtualPage(i)].use;
-      // No fue usada usada recientemente ni está modificada (Primer opción - Se detiene)
-      if(!dirty && !use)
-        return i;
-      // No fue usada recientemente pero si está modificada (Segunda opción)
-      if(snd == -1 && dirty && !use) {
-        snd = i;
-      }
-      // Fue usada recientemente pero no esta modificada (Tercera opción)
-      else if(trd == -1 && !dirty && use) {
-        trd = i;
-      }
-      // Fue usada recientemente y está modificada (Peor opcion)
-      else if(fth == -1){
-        fth = i;
-      } 
-
-      // Vamos desactivando las banderas de uso (Reloj)
-      processesTable->Get(memoryPages->ProccessID(i))->space->pageTable[memoryPages->VirtualPage(i)].use = false;
-    }
-
-    if(snd != -1) {
-      memoryPages->UpdateFIFOPointer(snd);
-      return snd;
-    } else if (trd != -1) {
-      memoryPages->UpdateFIFOPointer(trd);
-      return trd;
+    if (batchInstance < 0) {
+        snprintf(name, SWAP_NAME_SIZE, "SWAP.%u", sid);
     } else {
-      memoryPages->UpdateFIFOPointer(fth);
-      return fth;
+        snprintf(name, SWAP_NAME_SIZE, "SWAP.%d.%u", batchInstance, sid);
     }
-  #endif
-
-
-  #ifdef PRPOLICY_FIFO 
-    return memoryPages->NextFIFOPointer(); 
-  #endif
-    //ASSERT(pf < 324);
-    //unsigned reemplazo[] = {0, 0, 0, 0, 0, 1, 31, 29, 30, 29, 30, 29, 29, 27, 28, 27, 28, 27, 27, 25, 26, 25, 26, 25, 25, 23, 24, 23, 24, 23, 23, 21, 22, 21, 22, 21, 21, 19, 20, 19, 20, 19, 19, 17, 18, 17, 18, 17, 17, 15, 16, 15, 16, 15, 15, 27, 14, 27, 14, 27, 27, 12, 13, 12, 13, 13, 10, 11, 10, 11, 11, 8, 9, 8, 9, 9, 6, 7, 6, 7, 7, 4, 5, 4, 5, 5, 29, 3, 29, 3, 3, 30, 30, 25, 30, 30, 23, 28, 28, 28, 28, 21, 26, 26, 26, 26, 19, 24, 24, 24, 24, 17, 22, 22, 22, 22, 15, 20, 20, 20, 20, 27, 18, 18, 18, 18, 13, 16, 16, 16, 16, 11, 14, 14, 14, 14, 26, 12, 12, 12, 12, 10, 10, 10, 10, 8, 8, 8, 8, 6, 6, 6, 6, 4, 4, 4, 4, 29, 29, 29, 29, 25, 25, 25, 25, 24, 24, 24, 24, 22, 22, 22, 22, 20, 20, 20, 20, 18, 18, 18, 18, 16, 16, 16, 16, 14, 14, 14, 14, 12, 12, 12, 12, 10, 10, 10, 10, 8, 8, 8, 8, 6, 6, 6, 6, 4, 4, 4, 4, 14, 14, 14, 14, 29, 29, 29, 25, 25, 25, 24, 24, 24, 22, 22, 22, 20, 20, 20, 18, 18, 18, 16, 16, 16, 23, 23, 23, 21, 21, 21, 19, 19, 19, 17, 17, 17, 15, 15, 15, 27, 27, 27, 13, 13, 13, 11, 11, 11, 21, 21, 21, 26, 26, 9, 9, 7, 7, 5, 5, 3, 3, 30, 30, 28, 28, 19, 19, 17, 17, 15, 15, 27, 27, 13, 13, 11, 11, 21, 21, 26, 26, 9, 9, 7, 7, 27, 27, 5, 3, 30, 28, 19, 17, 15, 12, 10, 8, 6, 4, 14, 29, 25, 15, 1, 3, 4, 4, 5, 6, 7, 8, 7, 3, 0};
-    int i = rand() % memoryPages->NumItems();
-    //unsigned i =reemplazo[pf];
-    //spf++;
-    return i;
 }
+#endif
 
+unsigned
+AddressSpace::NumPages()
+{
+    return numPages;
+}
 
 void AddressSpace::Invalidate(unsigned page){
   pageTable[page].valid = false;
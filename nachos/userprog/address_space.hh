@@ -21,6 +21,10 @@
 
 const unsigned USER_STACK_SIZE = 1024;  ///< Increase this as necessary!
 
+/// Room needed for the name of a swap file (see
+/// `AddressSpace::SwapFileName`).
+const unsigned SWAP_NAME_SIZE = 32;
+
 
 class AddressSpace {
 public:
@@ -53,6 +57,13 @@ public:
 
     bool LoadTLB(unsigned page);
 
+    /// Write the use and dirty bits of a TLB entry back to its owner.
+    static void SyncTLBEntry(const TranslationEntry *entry);
+
+    /// Bring the bits of the page in physical page `frame` up to date in
+    /// the page table of its owner, and return its entry there.
+    static TranslationEntry *SyncFrame(unsigned frame);
+
     bool ReadOnly(unsigned page);
 
     bool Dirty(unsigned page);
@@ -61,17 +72,21 @@ public:
 
     #ifdef SWAP
     bool *InSwap;
+
+    /// Write in `name` the name of the swap file of process `sid`.
+    static void SwapFileName(unsigned sid, char *name);
+
+    /// Instance of a batch this Nachos is running (see `StartBatch`), or
+    /// -1.  It goes into the names of swap files, so that instances
+    /// running in the same directory do not share them.
+    static int batchInstance;
     #endif
 
     OpenFile *exe_file;
 
 private:
-    /// Select a random physical page number.
-    int PickVictim();
-
     /// Assume linear page table translation for now!
     TranslationEntry *pageTable;
-    int nextReplace;
     /// Number of pages in the virtual address space.
     unsigned numPages;
   //  int pf;
@@ -82,10 +82,9 @@ static void ReadOnlyHandler(ExceptionType et){
 static void InitNewThread(void *args)
 {
   #ifdef SWAP
-    char *swapFileName = new char[7];
-    sprintf(swapFileName, "SWAP.%u", currentThread->sid);
+    char swapFileName[SWAP_NAME_SIZE];
+    AddressSpace::SwapFileName(currentThread->sid, swapFileName);
     fileSystem->Create(swapFileName, currentThread->space->NumPages()*PAGE_SIZE);
-    delete [] swapFileName;
   #endif
   currentThread->space->InitRegisters();
 	currentThread->space->RestoreState();
@@ -103,11 +102,23 @@ static void InitNewThread(void *args)
   ASSERT(false);
 }
 
-unsigned StartNewProcess(OpenFile *exec, char **args)
+int StartNewProcess(OpenFile *exec, char **args, unsigned weight)
 {
   Thread *newThread = new Thread("child", true);
-  unsigned sid = processesTable->Add(newThread);
+  newThread->SetWeight(weight);
+  int sid = processesTable->Add(newThread);
   newThread->sid = sid;
+  if (sid == -1) {
+    // The table of processes is full; the thread was never forked.
+    DEBUG('e', "Error: no space identifier left for a new process.\n");
+    delete newThread;
+    delete exec;
+    for (unsigned i = 0; args != nullptr && args[i] != nullptr; i++) {
+      delete [] args[i];
+    }
+    delete [] args;
+    return -1;
+  }
   currentThread->childList->Append(newThread);
 	AddressSpace *space = new AddressSpace(exec);
   newThread->space = space;
@@ -115,6 +126,54 @@ unsigned StartNewProcess(OpenFile *exec, char **args)
   return sid;
 }
 
+/// Start the program whose name is at `filenameAddr` in user memory, with
+/// the arguments at `argvAddr`, as a child of the current process with
+/// weight `weight`.  `argvAddr` may only be null if `allowNullArgv`.
+///
+/// Shared by `Exec2` and `ExecW`.  Returns the space identifier of the new
+/// process, or -1 on error.
+static int
+ExecWithArgs(int filenameAddr, int argvAddr, unsigned weight,
+             bool allowNullArgv)
+{
+    if (filenameAddr == 0) {
+        DEBUG('e', "Error: address to filename string is null.\n");
+        return -1;
+    }
+    if (argvAddr == 0 && !allowNullArgv) {
+        DEBUG('e', "Error: address to argv is null.\n");
+        return -1;
+    }
+
+    char filename[FILE_NAME_MAX_LEN + 1];
+    if (!ReadStringFromUser(filenameAddr, filename, sizeof filename)) {
+        DEBUG('e', "Error: filename string too long (maximum is %u bytes).\n",
+              FILE_NAME_MAX_LEN);
+        return -1;
+    }
+
+    OpenFile *executable = fileSystem->Open(filename);
+    if (executable == nullptr) {
+        DEBUG('e', "Unable to execute file %s", filename);
+        return -1;
+    }
+
+    Executable exe (executable);
+    if (!exe.CheckMagic()) {
+        DEBUG('e', "File %s is not noff\n", filename);
+        delete executable;
+        return -1;
+    }
+
+    char **args = argvAddr == 0 ? nullptr : SaveArgs(argvAddr);
+    int spaceid = StartNewProcess(executable, args, weight);
+    if (spaceid != -1) {
+        DEBUG('e', "Success: File %s executed with weight %u.\n",
+              filename, weight);
+    }
+    return spaceid;
+}
+
 /// Handle a system call exception.
 ///
 /// * `et` is the kind of exception.  The list of possible exceptions is in
@@ -449,8 +508,9 @@ SyscallHandler(ExceptionType _et)
             }
 
 
-            unsigned spaceid = StartNewProcess(executable,nullptr);
-            DEBUG('e', "Success: File %s executed.\n", filename);
+            int spaceid = StartNewProcess(executable,nullptr);
+            if(spaceid != -1)
+              DEBUG('e', "Success: File %s executed.\n", filename);
             machine->WriteRegister(2, spaceid);
             break;
 	}
@@ -458,46 +518,24 @@ SyscallHandler(ExceptionType _et)
       case SC_EXEC2: {
                 int filenameAddr = machine->ReadRegister(4);
                 int argvAddr = machine->ReadRegister(5);
-                if (filenameAddr == 0) {
-                    DEBUG('e', "Error: address to filename string is null.\n");
-                    machine->WriteRegister(2, -1);  // Return error code.
-                    break;
-                }
-                if (argvAddr == 0) {
-                    DEBUG('e', "Error: address to argv is null.\n");
-                    machine->WriteRegister(2, -1);  // Return error code.
-                    break;
-                }
+                machine->WriteRegister(2, ExecWithArgs(filenameAddr, argvAddr,
+                                                       DEFAULT_WEIGHT,
+                                                       false));
+                break;
+      }
 
-                char filename[FILE_NAME_MAX_LEN + 1];
-                if (!ReadStringFromUser(filenameAddr,
-                                        filename, sizeof filename)) {
-                    DEBUG('e', "Error: filename string too long (maximum is %u bytes).\n",
-                          FILE_NAME_MAX_LEN);
+      case SC_EXECW: {
+                int filenameAddr = machine->ReadRegister(4);
+                int argvAddr = machine->ReadRegister(5);
+                int weight = machine->ReadRegister(6);
+                if (weight <= 0) {
+                    DEBUG('e', "Error: invalid weight %d.\n", weight);
                     machine->WriteRegister(2, -1);  // Return error code.
                     break;
                 }
-
-                OpenFile *executable = fileSystem->Open(filename);
-                if(executable == nullptr) {
-                  DEBUG('e', "Unable to execute file %s", filename);
-                  machine->WriteRegister(2,-1);
-                  break;
-                }
-
-                Executable exe (executable);
-
-                if(!exe.CheckMagic()){
-                  DEBUG('e', "File %s is not noff\n", filename);
-                  machine->WriteRegister(2,-1);
-                  break;
-                }
-
-                char **args = SaveArgs(argvAddr);
-
-                unsigned spaceid = StartNewProcess(executable, args);
-                DEBUG('e', "Success: File %s executed.\n", filename);
-                machine->WriteRegister(2, spaceid);
+                // Unlike `Exec2`, `argv` may be null.
+                machine->WriteRegister(2, ExecWithArgs(filenameAddr, argvAddr,
+                                                       weight, true));
                 break;
       }
 
@@ -533,6 +571,14 @@ SyscallHandler(ExceptionType _et)
               DEBUG('e', "Removing childs from thread %s\n", currentThread->GetName());
               (currentThread->childList->Pop())->Join();
             }
+            if (currentThread == batchThread) {
+                // The instance of the batch is over; otherwise the console
+                // would keep it waiting for input.  The host only keeps 8
+                // bits of the status, which must not end up as 0.
+                exitStatus = status == 0 ? 0
+                           : (status & 0xFF) != 0 ? status & 0xFF : 1;
+                interrupt->Halt();
+            }
             currentThread->Finish(status);
             break;
         }
@@ -6,6 +6,8 @@
 #define NACHOS_USERPROG_EXCEPTION__HH
 
 
+#include "threads/thread.hh"
+
 /// Set exception handlers for every exception type.
 ///
 /// Exception handlers are the entry points into the Nachos kernel.  They
@@ -17,8 +19,11 @@ void SetExceptionHandlers();
 // Initialize address-space of a new thread.
 //static void InitNewThread(void *args);
 
-// Start a new process.
-unsigned StartNewProcess(OpenFile *exec, char **args);
+// Start a new process, with `weight` shares of the CPU (see
+// `Thread::SetWeight`), and return its space identifier.  Return -1, having
+// freed `exec` and `args`, if there are too many processes.
+int StartNewProcess(OpenFile *exec, char **args,
+                    unsigned weight = DEFAULT_WEIGHT);
 
 
 #endif
@@ -0,0 +1,280 @@
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+
+#include "page_policy.hh"
+#include "address_space.hh"
+#include "threads/system.hh"
+#include "lib/coremap.hh"
+#include "machine/system_dep.hh"
+
+#include <string.h>
+
+
+extern Coremap *memoryPages;
+
+/// Virtual time of process `sid`: the ticks its thread has been running.
+static unsigned long
+VirtualTime(unsigned sid)
+{
+    Thread *thread = processesTable->Get(sid);
+    ASSERT(thread != nullptr);
+
+    unsigned long ticks = thread->cpuTicks;
+    if (thread->GetStatus() == RUNNING) {
+        ticks += stats->totalTicks - thread->dispatchedAt;
+    }
+    return ticks;
+}
+
+PagePolicy *
+PagePolicy::Create(const char *name, unsigned numFrames)
+{
+    ASSERT(name != nullptr);
+
+    if (strcmp(name, "fifo") == 0) {
+        return new FIFOPagePolicy;
+    } else if (strcmp(name, "random") == 0) {
+        return new RandomPagePolicy;
+    } else if (strcmp(name, "clock") == 0) {
+        return new ClockPagePolicy;
+    } else if (strcmp(name, "aging") == 0) {
+        return new AgingPagePolicy(numFrames);
+    } else if (strcmp(name, "wsclock") == 0) {
+        return new WSClockPagePolicy(numFrames);
+    }
+    return nullptr;
+}
+
+PagePolicy::~PagePolicy()
+{}
+
+void
+PagePolicy::Loaded(unsigned frame)
+{}
+
+void
+PagePolicy::Sample()
+{}
+
+const char *
+FIFOPagePolicy::Name() const
+{
+    return "fifo";
+}
+
+unsigned
+FIFOPagePolicy::PickVictim()
+{
+    unsigned victim;
+    do {
+        victim = memoryPages->NextFIFOPointer();
+    } while (memoryPages->IsPinned(victim));
+    return victim;
+}
+
+const char *
+RandomPagePolicy::Name() const
+{
+    return "random";
+}
+
+unsigned
+RandomPagePolicy::PickVictim()
+{
+    unsigned victim;
+    do {
+        victim = SystemDep::Random() % memoryPages->NumItems();
+    } while (memoryPages->IsPinned(victim));
+    return victim;
+}
+
+const char *
+ClockPagePolicy::Name() const
+{
+    return "clock";
+}
+
+unsigned
+ClockPagePolicy::PickVictim()
+{
+    // Best frame found of each class but the first, which stops the search:
+    // not used but dirty, used but clean, used and dirty.
+    int found[4] = {-1, -1, -1, -1};
+
+    for (unsigned steps = 0; steps < memoryPages->NumItems(); steps++) {
+        unsigned i = memoryPages->NextFIFOPointer();
+        if (memoryPages->IsPinned(i)) {
+            continue;
+        }
+        TranslationEntry *e = AddressSpace::SyncFrame(i);
+        unsigned c = e->use * 2 + e->dirty;
+        if (c == 0) {
+            return i;
+        }
+        if (found[c] == -1) {
+            found[c] = i;
+        }
+        e->use = false;
+    }
+
+    for (unsigned c = 1; c < 4; c++) {
+        if (found[c] != -1) {
+            memoryPages->UpdateFIFOPointer(found[c]);
+            return found[c];
+        }
+    }
+    ASSERT(false);
+    return 0;
+}
+
+AgingPagePolicy::AgingPagePolicy(unsigned numFrames_)
+{
+    numFrames = numFrames_;
+    age = new unsigned char[numFrames];
+    for (unsigned i = 0; i < numFrames; i++) {
+        age[i] = 0;
+    }
+    next = 0;
+    lastSample = 0;
+}
+
+AgingPagePolicy::~AgingPagePolicy()
+{
+    delete [] age;
+}
+
+const char *
+AgingPagePolicy::Name() const
+{
+    return "aging";
+}
+
+void
+AgingPagePolicy::Sample()
+{
+    if (stats->totalTicks - lastSample < AGING_PERIOD) {
+        return;
+    }
+    lastSample = stats->totalTicks;
+
+    for (unsigned i = 0; i < numFrames; i++) {
+        TranslationEntry *e = AddressSpace::SyncFrame(i);
+        if (e == nullptr) {
+            continue;
+        }
+        age[i] >>= 1;
+        if (e->use) {
+            age[i] |= 0x80;
+            e->use = false;
+        }
+    }
+}
+
+unsigned
+AgingPagePolicy::PickVictim()
+{
+    Sample();
+
+    int victim = -1;
+    unsigned best = 0;
+    for (unsigned k = 0; k < numFrames; k++) {
+        unsigned i = (next + k) % numFrames;
+        if (memoryPages->IsPinned(i)) {
+            continue;
+        }
+        TranslationEntry *e = AddressSpace::SyncFrame(i);
+        // A use since the last sample is more recent than anything in the
+        // counter.
+        unsigned key = e->use << 8 | age[i];
+        if (victim == -1 || key < best) {
+            victim = i;
+            best = key;
+        }
+    }
+    ASSERT(victim != -1);
+
+    next = (victim + 1) % numFrames;
+    return victim;
+}
+
+void
+AgingPagePolicy::Loaded(unsigned frame)
+{
+    ASSERT(frame < numFrames);
+
+    // The access that faulted is about to use it: it is the most recently
+    // used page.  Otherwise it would look older than every page used since
+    // the last sample, and be taken before that access.
+    age[frame] = 0xFF;
+    AddressSpace::SyncFrame(frame)->use = true;
+}
+
+WSClockPagePolicy::WSClockPagePolicy(unsigned numFrames_)
+{
+    numFrames = numFrames_;
+    lastUse = new unsigned long[numFrames];
+    for (unsigned i = 0; i < numFrames; i++) {
+        lastUse[i] = 0;
+    }
+    hand = 0;
+}
+
+WSClockPagePolicy::~WSClockPagePolicy()
+{
+    delete [] lastUse;
+}
+
+const char *
+WSClockPagePolicy::Name() const
+{
+    return "wsclock";
+}
+
+unsigned
+WSClockPagePolicy::PickVictim()
+{
+    int oldDirty = -1;
+    int oldest = -1;
+    unsigned long oldestIdle = 0;
+
+    for (unsigned steps = 0; steps < numFrames; steps++) {
+        unsigned i = hand;
+        hand = (hand + 1) % numFrames;
+        if (memoryPages->IsPinned(i)) {
+            continue;
+        }
+        TranslationEntry *e = AddressSpace::SyncFrame(i);
+        unsigned long now = VirtualTime(memoryPages->ProccessID(i));
+        if (e->use) {
+            e->use = false;
+            lastUse[i] = now;
+        }
+        unsigned long idle = now - lastUse[i];
+        if (idle > WSCLOCK_TAU) {
+            if (!e->dirty) {
+                return i;
+            }
+            if (oldDirty == -1) {
+                oldDirty = i;
+            }
+        }
+        if (oldest == -1 || idle > oldestIdle) {
+            oldest = i;
+            oldestIdle = idle;
+        }
+    }
+
+    int victim = oldDirty != -1 ? oldDirty : oldest;
+    ASSERT(victim != -1);
+    hand = (victim + 1) % numFrames;
+    return victim;
+}
+
+void
+WSClockPagePolicy::Loaded(unsigned frame)
+{
+    ASSERT(frame < numFrames);
+    lastUse[frame] = VirtualTime(currentThread->sid);
+}
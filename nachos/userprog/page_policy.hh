@@ -0,0 +1,121 @@
+/// Page replacement policies.
+///
+/// When a page fault finds no free frame, `AddressSpace::LoadTLB` asks the
+/// policy for a victim, which may belong to any process.  Frames pinned in
+/// the coremap are never chosen.
+///
+/// The policy is chosen at startup with `-prp`.
+///
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+#ifndef NACHOS_USERPROG_PAGEPOLICY__HH
+#define NACHOS_USERPROG_PAGEPOLICY__HH
+
+
+/// Ticks between two samples of the use bits, for `aging`.
+const unsigned long AGING_PERIOD = 2000;
+
+/// Virtual time, in ticks of its process, after which a page not used
+/// leaves the working set, for `wsclock`.
+const unsigned long WSCLOCK_TAU = 20000;
+
+
+class PagePolicy {
+public:
+
+    /// Create the policy called `name` (`fifo`, `random`, `clock`, `aging`
+    /// or `wsclock`) for a memory of `numFrames` frames.  Return null if
+    /// there is no such policy.
+    static PagePolicy *Create(const char *name, unsigned numFrames);
+
+    virtual ~PagePolicy();
+
+    virtual const char *Name() const = 0;
+
+    /// Choose the frame to replace; every frame is in use, and some of them
+    /// are not pinned.
+    virtual unsigned PickVictim() = 0;
+
+    /// A page was just loaded into frame `frame`.
+    virtual void Loaded(unsigned frame);
+
+    /// Called on every timer interrupt and page fault, for policies that
+    /// look at the use bits periodically.
+    virtual void Sample();
+};
+
+/// First in, first out: the frames are taken in turn.
+class FIFOPagePolicy : public PagePolicy {
+public:
+    virtual const char *Name() const;
+    virtual unsigned PickVictim();
+};
+
+class RandomPagePolicy : public PagePolicy {
+public:
+    virtual const char *Name() const;
+    virtual unsigned PickVictim();
+};
+
+/// Enhanced clock: go round the frames from after the last victim, looking
+/// for the lowest class by use, then dirty bit, and clearing the use bits
+/// on the way.
+class ClockPagePolicy : public PagePolicy {
+public:
+    virtual const char *Name() const;
+    virtual unsigned PickVictim();
+};
+
+/// Least recently used, approximated by aging: every `AGING_PERIOD` ticks
+/// the counter of each frame is shifted right, with its use bit going into
+/// the highest bit, and the use bit is cleared.  The victim is the frame
+/// with the lowest counter, not counting frames used since the last sample.
+///
+/// Dirty pages are not preferred: counters of pages in use all end up
+/// equal when faults come faster than samples, and the one clean page would
+/// then be taken again and again.
+class AgingPagePolicy : public PagePolicy {
+public:
+    AgingPagePolicy(unsigned numFrames);
+    virtual ~AgingPagePolicy();
+
+    virtual const char *Name() const;
+    virtual unsigned PickVictim();
+    virtual void Loaded(unsigned frame);
+    virtual void Sample();
+
+private:
+    unsigned char *age;
+    unsigned numFrames;
+    unsigned next;  ///< Frame to start looking at, after the last victim.
+    unsigned long lastSample;
+};
+
+/// WSClock: go round the frames like the clock, but keep, for each frame,
+/// the virtual time of its owner (the ticks its thread has run) when the
+/// page was last seen used.  A page not used for more than `WSCLOCK_TAU`
+/// of that time is out of the working set and can go, clean ones first.
+///
+/// Dirty pages out of the working set would be scheduled for writing and
+/// passed over; page outs are synchronous here, so the first of them is
+/// only taken if no clean one is found in a whole turn.  If every page is
+/// in its working set, the one unused for longest goes.
+class WSClockPagePolicy : public PagePolicy {
+public:
+    WSClockPagePolicy(unsigned numFrames);
+    virtual ~WSClockPagePolicy();
+
+    virtual const char *Name() const;
+    virtual unsigned PickVictim();
+    virtual void Loaded(unsigned frame);
+
+private:
+    unsigned long *lastUse;
+    unsigned numFrames;
+    unsigned hand;
+};
+
+
+#endif
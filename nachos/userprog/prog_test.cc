@@ -13,8 +13,10 @@
 #include "machine/console.hh"
 #include "threads/semaphore.hh"
 #include "threads/system.hh"
+#include "machine/system_dep.hh"
 
 #include <stdio.h>
+#include <stdlib.h>
 
 
 /// Run a user program.
@@ -31,16 +33,20 @@ StartProcess(const char *filename)
         return;
     }
 
+    int sid = processesTable->Add(currentThread);
+    if (sid == -1) {
+        printf("Unable to start %s: too many processes\n", filename);
+        delete executable;
+        return;
+    }
     AddressSpace *space = new AddressSpace(executable);
-    unsigned sid = processesTable->Add(currentThread);
     currentThread->sid = sid;
     currentThread->space = space;
 
     #ifdef SWAP
-    char *swapFileName = new char[7];
-    sprintf(swapFileName, "SWAP.%u", sid);
+    char swapFileName[SWAP_NAME_SIZE];
+    AddressSpace::SwapFileName(sid, swapFileName);
     fileSystem->Create(swapFileName, space->NumPages()*PAGE_SIZE);
-    delete [] swapFileName;
     #endif
 
     //delete executable;
@@ -53,6 +59,61 @@ StartProcess(const char *filename)
                      // exits by doing the system call `Exit`.
 }
 
+/// Run `count` independent instances of a user program, side by side.
+///
+/// The kernel assumes a single host thread throughout (it relies on
+/// disabling interrupts for mutual exclusion), so instead of host threads,
+/// each instance gets a host process: a copy of this Nachos, already
+/// initialized, with its own machine, memory, process table and open files,
+/// and nothing to synchronize with the others.  As many instances as there
+/// are host processors run at a time.
+///
+/// Each instance prints its own statistics when it halts, and exits with
+/// the status its program passed to `Exit`; then this prints how many of
+/// them failed (could not be started, crashed or exited with a status other
+/// than 0) and how long the whole batch took, and exits.
+void
+StartBatch(const char *filename, unsigned count)
+{
+    ASSERT(filename != nullptr);
+
+#ifdef FILESYS
+    // Every instance would write to the same simulated disk.
+    printf("Batches only work with the stub file system.\n");
+    return;
+#else
+    unsigned slots = SystemDep::HostProcessors();
+    unsigned started = 0, running = 0, failed = 0;
+    double start = SystemDep::HostTime();
+
+    while (started < count || running > 0) {
+        if (started < count && running < slots) {
+            if (SystemDep::Fork() == 0) {
+#ifdef SWAP
+                AddressSpace::batchInstance = started;
+#endif
+                stats->hostStart = SystemDep::HostTime();
+                batchThread = currentThread;
+                StartProcess(filename);
+                exit(1);  // The program could not be started.
+            }
+            started++;
+            running++;
+        } else {
+            if (SystemDep::WaitChild() != 0) {
+                failed++;
+            }
+            running--;
+        }
+    }
+
+    printf("Batch: %u instances of %s, %u failed, %u at a time,"
+           " %.3f host seconds\n", count, filename, failed, slots,
+           SystemDep::HostTime() - start);
+    Cleanup();
+#endif
+}
+
 /// Data structures needed for the console test.
 ///
 /// Threads making I/O requests wait on a `Semaphore` to delay until the I/O
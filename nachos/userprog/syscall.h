@@ -32,6 +32,7 @@
 #define SC_READ    14
 #define SC_WRITE   15
 #define SC_EXEC2   16
+#define SC_EXECW   17
 
 
 #ifndef IN_ASM
@@ -63,6 +64,10 @@ SpaceId Exec(char *name);
 
 SpaceId Exec2(char *name, char **argv);
 
+/// Like `Exec2`, but the new program gets `weight` (at least 1) shares of
+/// the CPU under stride scheduling; `argv` may be null.
+SpaceId ExecWeighted(char *name, char **argv, int weight);
+
 /// Only return once the the user program `id` has finished.
 ///
 /// Return the exit status.
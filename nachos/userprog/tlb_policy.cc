@@ -0,0 +1,171 @@
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+
+#include "tlb_policy.hh"
+#include "address_space.hh"
+#include "machine/system_dep.hh"
+#include "lib/utility.hh"
+
+#include <string.h>
+
+
+/// Clear the use bit of a TLB entry, once it has been recorded in the page
+/// table of its owner (the page replacement policy relies on it).
+static void
+ClearUse(TranslationEntry *entry)
+{
+    AddressSpace::SyncTLBEntry(entry);
+    entry->use = false;
+}
+
+TLBPolicy *
+TLBPolicy::Create(const char *name, unsigned size)
+{
+    ASSERT(name != nullptr);
+
+    if (strcmp(name, "fifo") == 0) {
+        return new FIFOTLBPolicy(size);
+    } else if (strcmp(name, "random") == 0) {
+        return new RandomTLBPolicy;
+    } else if (strcmp(name, "lru") == 0) {
+        return new LRUTLBPolicy(size);
+    } else if (strcmp(name, "nru") == 0) {
+        return new NRUTLBPolicy(size);
+    }
+    return nullptr;
+}
+
+TLBPolicy::~TLBPolicy()
+{}
+
+void
+TLBPolicy::Loaded(TranslationEntry *tlb, unsigned i)
+{}
+
+FIFOTLBPolicy::FIFOTLBPolicy(unsigned size)
+{
+    next = new unsigned[size];
+    for (unsigned i = 0; i < size; i++) {
+        next[i] = 0;
+    }
+}
+
+FIFOTLBPolicy::~FIFOTLBPolicy()
+{
+    delete [] next;
+}
+
+const char *
+FIFOTLBPolicy::Name() const
+{
+    return "fifo";
+}
+
+unsigned
+FIFOTLBPolicy::PickVictim(TranslationEntry *tlb, unsigned first,
+                          unsigned ways)
+{
+    unsigned victim = first + next[first];
+    next[first] = (next[first] + 1) % ways;
+    return victim;
+}
+
+const char *
+RandomTLBPolicy::Name() const
+{
+    return "random";
+}
+
+unsigned
+RandomTLBPolicy::PickVictim(TranslationEntry *tlb, unsigned first,
+                            unsigned ways)
+{
+    return first + SystemDep::Random() % ways;
+}
+
+LRUTLBPolicy::LRUTLBPolicy(unsigned size)
+{
+    age = new unsigned char[size];
+    for (unsigned i = 0; i < size; i++) {
+        age[i] = 0;
+    }
+}
+
+LRUTLBPolicy::~LRUTLBPolicy()
+{
+    delete [] age;
+}
+
+const char *
+LRUTLBPolicy::Name() const
+{
+    return "lru";
+}
+
+unsigned
+LRUTLBPolicy::PickVictim(TranslationEntry *tlb, unsigned first,
+                         unsigned ways)
+{
+    unsigned victim = first;
+    for (unsigned i = first; i < first + ways; i++) {
+        age[i] >>= 1;
+        if (tlb[i].use) {
+            age[i] |= 0x80;
+            ClearUse(&tlb[i]);
+        }
+        if (age[i] < age[victim]) {
+            victim = i;
+        }
+    }
+    return victim;
+}
+
+void
+LRUTLBPolicy::Loaded(TranslationEntry *tlb, unsigned i)
+{
+    age[i] = 0x80;  // It is about to be used.
+}
+
+NRUTLBPolicy::NRUTLBPolicy(unsigned size)
+{
+    next = new unsigned[size];
+    for (unsigned i = 0; i < size; i++) {
+        next[i] = 0;
+    }
+}
+
+NRUTLBPolicy::~NRUTLBPolicy()
+{
+    delete [] next;
+}
+
+const char *
+NRUTLBPolicy::Name() const
+{
+    return "nru";
+}
+
+unsigned
+NRUTLBPolicy::PickVictim(TranslationEntry *tlb, unsigned first,
+                         unsigned ways)
+{
+    unsigned victim = 0, bestClass = 4;
+    for (unsigned w = 0; w < ways && bestClass > 0; w++) {
+        unsigned i = first + (next[first] + w) % ways;
+        unsigned c = tlb[i].use * 2 + tlb[i].dirty;
+        if (c < bestClass) {
+            bestClass = c;
+            victim = i;
+        }
+    }
+    if (bestClass >= 2) {
+        // Everything was used since the last reset: start over.
+        for (unsigned i = first; i < first + ways; i++) {
+            ClearUse(&tlb[i]);
+        }
+    }
+    next[first] = (victim - first + 1) % ways;
+    return victim;
+}
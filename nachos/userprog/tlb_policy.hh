@@ -0,0 +1,98 @@
+/// Replacement policies for the TLB.
+///
+/// The TLB is managed by the kernel: on a miss, `AddressSpace::LoadTLB`
+/// loads the missing entry into the set of its page, taking an invalid
+/// entry if there is one and asking the policy for a victim otherwise.
+///
+/// The policy is chosen at startup with `-tlbp`.
+///
+/// Copyright (c) 2016-2021 Docentes de la Universidad Nacional de Rosario.
+/// All rights reserved.  See `copyright.h` for copyright notice and
+/// limitation of liability and disclaimer of warranty provisions.
+
+#ifndef NACHOS_USERPROG_TLBPOLICY__HH
+#define NACHOS_USERPROG_TLBPOLICY__HH
+
+
+#include "machine/translation_entry.hh"
+
+
+class TLBPolicy {
+public:
+
+    /// Create the policy called `name` (`fifo`, `random`, `lru` or `nru`)
+    /// for a TLB of `size` entries.  Return null if there is no such
+    /// policy.
+    static TLBPolicy *Create(const char *name, unsigned size);
+
+    virtual ~TLBPolicy();
+
+    virtual const char *Name() const = 0;
+
+    /// Choose the entry to replace among the `ways` entries of `tlb`
+    /// starting at `first`, all of them valid.
+    virtual unsigned PickVictim(TranslationEntry *tlb, unsigned first,
+                                unsigned ways) = 0;
+
+    /// Entry `i` of `tlb` was just loaded.
+    virtual void Loaded(TranslationEntry *tlb, unsigned i);
+};
+
+/// Replace the entries of each set in the order they were loaded.
+class FIFOTLBPolicy : public TLBPolicy {
+public:
+    FIFOTLBPolicy(unsigned size);
+    virtual ~FIFOTLBPolicy();
+
+    virtual const char *Name() const;
+    virtual unsigned PickVictim(TranslationEntry *tlb, unsigned first,
+                                unsigned ways);
+
+private:
+    unsigned *next;  ///< Next way to replace, by first entry of the set.
+};
+
+/// Replace any entry of the set.
+class RandomTLBPolicy : public TLBPolicy {
+public:
+    virtual const char *Name() const;
+    virtual unsigned PickVictim(TranslationEntry *tlb, unsigned first,
+                                unsigned ways);
+};
+
+/// Approximate LRU by aging: on every miss, the use bits of the set are
+/// shifted into an 8 bit history of each entry and cleared, and the entry
+/// with the lowest history is replaced.
+class LRUTLBPolicy : public TLBPolicy {
+public:
+    LRUTLBPolicy(unsigned size);
+    virtual ~LRUTLBPolicy();
+
+    virtual const char *Name() const;
+    virtual unsigned PickVictim(TranslationEntry *tlb, unsigned first,
+                                unsigned ways);
+    virtual void Loaded(TranslationEntry *tlb, unsigned i);
+
+private:
+    unsigned char *age;
+};
+
+/// Not recently used: replace an entry of the lowest class (by use, then
+/// dirty bit), going round the set from after the last victim.  When every
+/// entry of the set has been used, the use bits of the set are cleared.
+class NRUTLBPolicy : public TLBPolicy {
+public:
+    NRUTLBPolicy(unsigned size);
+    virtual ~NRUTLBPolicy();
+
+    virtual const char *Name() const;
+    virtual unsigned PickVictim(TranslationEntry *tlb, unsigned first,
+                                unsigned ways);
+
+private:
+    unsigned *next;  ///< Way to start looking at, by first entry of the
+                     ///< set.
+};
+
+
+#endif